@@ -21,7 +21,6 @@
 #include <memory>
 
 #include <QtGlobal>
-#include <QProcess>
 #include <QStringList>
 
 #include "budgie_desktop_env.h"
@@ -34,9 +33,12 @@
 #include "wayfire_desktop_env.h"
 #include <model/application_menu_config.h>
 #include <model/multi_dock_model.h>
+#include <utils/command_runner.h>
 
 namespace crystaldock {
 
+QString DesktopEnv::defaultWebBrowser_;
+
 DesktopEnv* DesktopEnv::getDesktopEnv() {
   QString currentDesktopEnv = getDesktopEnvName();
   if (currentDesktopEnv == "Budgie") {
@@ -81,13 +83,21 @@ std::vector<QString> DesktopEnv::getDefaultLaunchers() const {
   return { defaultWebBrowser() };
 }
 
+/* static */ void DesktopEnv::queryDefaultWebBrowser() {
+  CommandOptions options;
+  options.timeoutMs = kQueryTimeoutMs;
+  options.coalesce = true;
+  CommandRunner::self()->run("xdg-settings", {"get", "default-web-browser"}, nullptr,
+                             [](const CommandResult& result) {
+    const QString desktopFile = QString::fromUtf8(result.output).trimmed();
+    if (result.ok() && desktopFile.endsWith(".desktop")) {
+      defaultWebBrowser_ = desktopFile.first(desktopFile.lastIndexOf('.'));
+    }
+  }, options);
+}
+
 QString DesktopEnv::defaultWebBrowser() const {
-  QProcess process;
-  process.start("xdg-settings", {"get", "default-web-browser"});
-  process.waitForFinished(1000 /*msecs*/);
-  QString desktopFile = process.readAllStandardOutput().trimmed();
-  auto appId = desktopFile.first(desktopFile.lastIndexOf('.'));
-  return !appId.isEmpty() ? appId : "firefox";
+  return !defaultWebBrowser_.isEmpty() ? defaultWebBrowser_ : "firefox";
 }
 
 }  // namespace crystaldock
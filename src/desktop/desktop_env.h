@@ -67,9 +67,17 @@ class DesktopEnv {
   //   wallpaper: path to the wallpaper file.
   virtual bool setWallpaper(int screen, const QString& wallpaper) { return false; }
 
+  // Looks up the default web browser in the background, for defaultWebBrowser().
+  static void queryDefaultWebBrowser();
+
   // Returns the app ID of the default web browser.
-  // Uses Firefox as fallback if default web browser not set.
+  // Uses Firefox as fallback if default web browser not set or not known yet.
   QString defaultWebBrowser() const;
+
+ private:
+  static constexpr int kQueryTimeoutMs = 5000;
+
+  static QString defaultWebBrowser_;
 };
 
 }  // namespace crystaldock
@@ -18,9 +18,11 @@
 
 #include "lxqt_desktop_env.h"
 
-#include <QProcess>
+#include <QDir>
+#include <QProcessEnvironment>
 
 #include <model/multi_dock_model.h>
+#include <utils/command_runner.h>
 
 namespace crystaldock {
 
@@ -68,7 +70,9 @@ std::vector<QString> LxqtDesktopEnv::getDefaultLaunchers() const {
 
 bool LxqtDesktopEnv::setWallpaper(int screen, const QString& wallpaper) {
   // LXQt doesn't support setting different wallpapers for different screens.
-  return QProcess::startDetached("pcmanfm-qt", {"--set-wallpaper=" + wallpaper});
+  return CommandRunner::self()->launch("pcmanfm-qt", {"--set-wallpaper=" + wallpaper},
+                                       QProcessEnvironment::systemEnvironment(),
+                                       QDir::homePath());
 }
 
 }  // namespace crystaldock
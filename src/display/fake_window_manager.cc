@@ -0,0 +1,136 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fake_window_manager.h"
+
+#include <algorithm>
+
+namespace crystaldock {
+
+std::unordered_map<void*, std::unique_ptr<WindowInfo>> FakeWindowManager::windows_;
+void* FakeWindowManager::activeWindow_;
+std::vector<VirtualDesktopInfo> FakeWindowManager::desktops_;
+std::string FakeWindowManager::currentDesktop_;
+
+/* static */ void FakeWindowManager::init(int numDesktops) {
+  desktops_.clear();
+  for (int i = 1; i <= numDesktops; ++i) {
+    desktops_.push_back({"desktop-" + std::to_string(i), static_cast<uint32_t>(i),
+                         "Desktop " + std::to_string(i), nullptr});
+  }
+  currentDesktop_ = desktops_.empty() ? "" : desktops_[0].id;
+  WindowSystem::initWithoutCompositor(bindWindowManagerFunctions,
+                                      bindVirtualDesktopManagerFunctions);
+}
+
+/* static */ void FakeWindowManager::bindWindowManagerFunctions(
+    WindowManager* windowManager) {
+  windowManager->activateOrMinimizeWindow = FakeWindowManager::activateOrMinimizeWindow;
+  windowManager->activateWindow = FakeWindowManager::activateWindow;
+  windowManager->minimizeWindow = FakeWindowManager::minimizeWindow;
+  windowManager->activeWindow = FakeWindowManager::activeWindow;
+  windowManager->closeWindow = FakeWindowManager::closeWindow;
+  windowManager->resetActiveWindow = FakeWindowManager::resetActiveWindow;
+  windowManager->windows = FakeWindowManager::windows;
+  windowManager->setShowingDesktop = FakeWindowManager::setShowingDesktop;
+  windowManager->showingDesktop = FakeWindowManager::showingDesktop;
+}
+
+/* static */ void FakeWindowManager::bindVirtualDesktopManagerFunctions(
+    VirtualDesktopManager* virtualDesktopManager) {
+  virtualDesktopManager->numberOfDesktops = FakeWindowManager::numberOfDesktops;
+  virtualDesktopManager->desktops = FakeWindowManager::desktops;
+  virtualDesktopManager->currentDesktop = FakeWindowManager::currentDesktop;
+  virtualDesktopManager->setCurrentDesktop = FakeWindowManager::setCurrentDesktop;
+}
+
+/* static */ void* FakeWindowManager::addWindow(
+    const std::string& appId, const std::string& title, const std::string& desktop) {
+  auto info = std::make_unique<WindowInfo>();
+  // The WindowInfo's own address serves as the window handle.
+  void* window = info.get();
+  static uint32_t mapping_order = 0;
+  info->window = window;
+  info->appId = appId;
+  info->title = title;
+  info->desktop = desktop;
+  info->initialized = true;
+  info->mapping_order = mapping_order++;
+  info->width = 800;
+  info->height = 600;
+  windows_[window] = std::move(info);
+  emit WindowSystem::self()->windowAdded(windows_[window].get());
+  return window;
+}
+
+/* static */ void FakeWindowManager::removeWindow(void* window) {
+  if (windows_.count(window) == 0) {
+    return;
+  }
+
+  emit WindowSystem::self()->windowRemoved(window);
+  if (activeWindow_ == window) {
+    activeWindow_ = nullptr;
+  }
+  windows_.erase(window);
+}
+
+/* static */ void FakeWindowManager::setWindowTitle(void* window, const std::string& title) {
+  if (windows_.count(window) == 0) {
+    return;
+  }
+
+  windows_[window]->title = title;
+  emit WindowSystem::self()->windowTitleChanged(windows_[window].get());
+}
+
+/* static */ void FakeWindowManager::setWindowGeometry(
+    void* window, int32_t x, int32_t y, uint32_t width, uint32_t height) {
+  if (windows_.count(window) == 0) {
+    return;
+  }
+
+  windows_[window]->x = x;
+  windows_[window]->y = y;
+  windows_[window]->width = width;
+  windows_[window]->height = height;
+  emit WindowSystem::self()->windowGeometryChanged(windows_[window].get());
+}
+
+/* static */ std::vector<const WindowInfo*> FakeWindowManager::windows() {
+  std::vector<const WindowInfo*> windows;
+  for (const auto& element : windows_) {
+    windows.push_back(element.second.get());
+  }
+  std::sort(windows.begin(), windows.end(),
+            [](const WindowInfo* w1, const WindowInfo* w2) {
+    return w1->mapping_order < w2->mapping_order;
+  });
+  return windows;
+}
+
+/* static */ void FakeWindowManager::setCurrentDesktop(std::string_view desktop) {
+  if (desktop == currentDesktop_) {
+    return;
+  }
+
+  currentDesktop_ = desktop;
+  emit WindowSystem::self()->currentDesktopChanged(currentDesktop_);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,77 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_FAKE_WINDOW_MANAGER_H_
+#define CRYSTALDOCK_FAKE_WINDOW_MANAGER_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "window_system.h"
+
+namespace crystaldock {
+
+// In-memory window manager and virtual desktop manager for benchmarks.
+// Windows are created and changed by the caller, which emits the same
+// WindowSystem signals as the real backends.
+class FakeWindowManager {
+ public:
+  // Binds the fake backend to WindowSystem, with `numDesktops` virtual desktops.
+  static void init(int numDesktops);
+
+  static void bindWindowManagerFunctions(WindowManager* windowManager);
+  static void bindVirtualDesktopManagerFunctions(VirtualDesktopManager* virtualDesktopManager);
+
+  // Event generators.
+  static void* addWindow(const std::string& appId, const std::string& title,
+                         const std::string& desktop);
+  static void removeWindow(void* window);
+  static void setWindowTitle(void* window, const std::string& title);
+  static void setWindowGeometry(void* window, int32_t x, int32_t y,
+                                uint32_t width, uint32_t height);
+
+  // WindowManager functions.
+  static std::vector<const WindowInfo*> windows();
+  static void* activeWindow() { return activeWindow_; }
+  static void resetActiveWindow() { activeWindow_ = nullptr; }
+  static void activateWindow(void* window) { activeWindow_ = window; }
+  static void activateOrMinimizeWindow(void* window) { activeWindow_ = window; }
+  static void minimizeWindow(void* window) {}
+  static void closeWindow(void* window) { removeWindow(window); }
+  static bool showingDesktop() { return false; }
+  static void setShowingDesktop(bool show) {}
+
+  // VirtualDesktopManager functions.
+  static int numberOfDesktops() { return static_cast<int>(desktops_.size()); }
+  static const std::vector<VirtualDesktopInfo>& desktops() { return desktops_; }
+  static std::string_view currentDesktop() { return currentDesktop_; }
+  static void setCurrentDesktop(std::string_view desktop);
+
+ private:
+  static std::unordered_map<void*, std::unique_ptr<WindowInfo>> windows_;
+  static void* activeWindow_;
+  static std::vector<VirtualDesktopInfo> desktops_;
+  static std::string currentDesktop_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_FAKE_WINDOW_MANAGER_H_
@@ -18,10 +18,15 @@
 
 #include "kde_virtual_desktop_manager.h"
 
+#include <algorithm>
+
 namespace crystaldock {
 
 org_kde_plasma_virtual_desktop_management* KdeVirtualDesktopManager::virtual_desktop_management_;
 std::vector<VirtualDesktopInfo> KdeVirtualDesktopManager::desktops_;
+std::unordered_map<std::string, size_t> KdeVirtualDesktopManager::desktopIndexes_;
+std::unordered_map<struct org_kde_plasma_virtual_desktop*, size_t>
+    KdeVirtualDesktopManager::proxyIndexes_;
 std::string KdeVirtualDesktopManager::currentDesktop_;
 
 /* static */ KdeVirtualDesktopManager* KdeVirtualDesktopManager::self() {
@@ -59,16 +64,38 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
 }
 
 /* static */ void KdeVirtualDesktopManager::setCurrentDesktop(std::string_view desktopId) {
-  auto pos = std::find_if(desktops_.begin(), desktops_.end(),
-               [desktopId](auto& e) { return e.id == desktopId; });
-  if (pos != desktops_.end()) {
-    auto desktop = static_cast<struct org_kde_plasma_virtual_desktop*>(pos->virtual_desktop);
+  auto* info = findDesktop(std::string{desktopId});
+  if (info != nullptr) {
+    auto desktop = static_cast<struct org_kde_plasma_virtual_desktop*>(info->virtual_desktop);
     if (desktop != nullptr) {
       org_kde_plasma_virtual_desktop_request_activate(desktop);
     }
   }
 }
 
+/* static */ VirtualDesktopInfo* KdeVirtualDesktopManager::findDesktop(
+    const std::string& desktopId) {
+  auto it = desktopIndexes_.find(desktopId);
+  return (it != desktopIndexes_.end()) ? &desktops_[it->second] : nullptr;
+}
+
+/* static */ VirtualDesktopInfo* KdeVirtualDesktopManager::findDesktop(
+    struct org_kde_plasma_virtual_desktop* virtual_desktop) {
+  auto it = proxyIndexes_.find(virtual_desktop);
+  return (it != proxyIndexes_.end()) ? &desktops_[it->second] : nullptr;
+}
+
+/* static */ void KdeVirtualDesktopManager::reindex() {
+  desktopIndexes_.clear();
+  proxyIndexes_.clear();
+  for (size_t pos = 0; pos < desktops_.size(); ++pos) {
+    desktops_[pos].number = pos + 1;
+    desktopIndexes_[desktops_[pos].id] = pos;
+    proxyIndexes_[static_cast<struct org_kde_plasma_virtual_desktop*>(
+        desktops_[pos].virtual_desktop)] = pos;
+  }
+}
+
 // org_kde_plasma_virtual_desktop_management interface.
 
 /* static */ void KdeVirtualDesktopManager::desktop_management_desktop_created(
@@ -80,7 +107,8 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
   auto* virtual_desktop = org_kde_plasma_virtual_desktop_management_get_virtual_desktop(
       virtual_desktop_management, desktop_id);
   info.virtual_desktop = virtual_desktop;
-  desktops_.insert(desktops_.begin() + position, info);
+  desktops_.insert(desktops_.begin() + std::min<size_t>(position, desktops_.size()), info);
+  reindex();
   org_kde_plasma_virtual_desktop_add_listener(
       virtual_desktop, &virtual_desktop_listener_, NULL);
   emit self()->numberOfDesktopsChanged(desktops_.size());
@@ -89,11 +117,12 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
 /* static */ void KdeVirtualDesktopManager::desktop_management_desktop_removed(
     void* data, org_kde_plasma_virtual_desktop_management* virtual_desktop_management,
     const char* desktop_id) {
-  desktops_.erase(std::find_if(desktops_.begin(), desktops_.end(),
-                               [desktop_id](auto& e) { return e.id == desktop_id; }));
-  for (unsigned int pos = 0; pos < desktops_.size(); ++pos) {
-    desktops_[pos].number = pos + 1;
+  auto it = desktopIndexes_.find(desktop_id);
+  if (it == desktopIndexes_.end()) {
+    return;
   }
+  desktops_.erase(desktops_.begin() + it->second);
+  reindex();
   emit self()->numberOfDesktopsChanged(desktops_.size());
 }
 
@@ -114,10 +143,11 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
     void *data,
     struct org_kde_plasma_virtual_desktop *virtual_desktop,
     const char *desktop_id) {
-  auto pos = std::find_if(desktops_.begin(), desktops_.end(),
-               [virtual_desktop](auto& e) { return e.virtual_desktop == virtual_desktop; });
-  if (pos != desktops_.end()) {
-    pos->id = desktop_id;
+  auto* info = findDesktop(virtual_desktop);
+  if (info != nullptr) {
+    desktopIndexes_.erase(info->id);
+    info->id = desktop_id;
+    desktopIndexes_[info->id] = info->number - 1;
   }
 }
 
@@ -125,22 +155,20 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
     void *data,
     struct org_kde_plasma_virtual_desktop *virtual_desktop,
     const char *name) {
-  auto pos = std::find_if(desktops_.begin(), desktops_.end(),
-               [virtual_desktop](auto& e) { return e.virtual_desktop == virtual_desktop; });
-  if (pos != desktops_.end()) {
-    pos->name = name;
-    emit KdeVirtualDesktopManager::self()->desktopNameChanged(pos->id, pos->name);
+  auto* info = findDesktop(virtual_desktop);
+  if (info != nullptr) {
+    info->name = name;
+    emit KdeVirtualDesktopManager::self()->desktopNameChanged(info->id, info->name);
   }
 }
 
 /* static */ void KdeVirtualDesktopManager::desktop_activated(
     void *data,
     struct org_kde_plasma_virtual_desktop *virtual_desktop) {
-  auto pos = std::find_if(desktops_.begin(), desktops_.end(),
-               [virtual_desktop](auto& e) { return e.virtual_desktop == virtual_desktop; });
-  if (pos != desktops_.end()) {
-    if (currentDesktop_ != pos->id) {
-      currentDesktop_ = pos->id;
+  auto* info = findDesktop(virtual_desktop);
+  if (info != nullptr) {
+    if (currentDesktop_ != info->id) {
+      currentDesktop_ = info->id;
       emit self()->currentDesktopChanged(currentDesktop_);
     }
   }
@@ -20,6 +20,7 @@
 #define KDE_VIRTUAL_DESKTOP_MANAGER_H_
 
 #include <string>
+#include <unordered_map>
 
 #include "plasma_virtual_desktop.h"
 #include "window_system.h"
@@ -44,11 +45,17 @@ class KdeVirtualDesktopManager : public QObject {
   static void bindVirtualDesktopManagerFunctions(VirtualDesktopManager* virtualDesktopManager);
 
   static int numberOfDesktops();
-  static std::vector<VirtualDesktopInfo> desktops() { return desktops_; }
+  static const std::vector<VirtualDesktopInfo>& desktops() { return desktops_; }
   static std::string_view currentDesktop();
   static void setCurrentDesktop(std::string_view);
 
  private:
+  // Returns the desktop with the given ID / proxy, or nullptr if not found.
+  static VirtualDesktopInfo* findDesktop(const std::string& desktopId);
+  static VirtualDesktopInfo* findDesktop(struct org_kde_plasma_virtual_desktop* virtual_desktop);
+
+  // Renumbers the desktops and rebuilds the indexes after a desktop is created or removed.
+  static void reindex();
 
   // org_kde_plasma_virtual_desktop_management interface.
 
@@ -111,6 +118,9 @@ class KdeVirtualDesktopManager : public QObject {
   static org_kde_plasma_virtual_desktop_management* virtual_desktop_management_;
 
   static std::vector<VirtualDesktopInfo> desktops_;
+  // Indexes into desktops_, by desktop ID and by proxy.
+  static std::unordered_map<std::string, size_t> desktopIndexes_;
+  static std::unordered_map<struct org_kde_plasma_virtual_desktop*, size_t> proxyIndexes_;
   // Current desktop ID.
   static std::string currentDesktop_;
 };
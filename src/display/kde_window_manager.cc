@@ -18,6 +18,20 @@
 
 #include "kde_window_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iostream>
+
+#include <QDataStream>
+#include <QGuiApplication>
+#include <QIcon>
+
+#include <utils/icon_utils.h>
+
+#include "wayland_event_trace.h"
+
 namespace crystaldock {
 
 org_kde_plasma_window_management* KdeWindowManager::window_management_;
@@ -27,6 +41,16 @@ std::unordered_map<std::string, struct org_kde_plasma_window*> KdeWindowManager:
 std::vector<std::string> KdeWindowManager::stackingOrder_;
 struct org_kde_plasma_window* KdeWindowManager::activeWindow_;
 bool KdeWindowManager::showingDesktop_;
+std::unordered_map<struct org_kde_plasma_window*, std::unique_ptr<KdeWindowManager::IconFetch>>
+    KdeWindowManager::iconFetches_;
+std::unordered_map<std::string, QImage> KdeWindowManager::iconCache_;
+
+KdeWindowManager::IconFetch::~IconFetch() {
+  notifier.reset();
+  if (fd >= 0) {
+    close(fd);
+  }
+}
 
 /* static */ KdeWindowManager* KdeWindowManager::self() {
   static KdeWindowManager self;
@@ -38,6 +62,10 @@ bool KdeWindowManager::showingDesktop_;
   window_management_ = window_management;
   org_kde_plasma_window_management_add_listener(
       window_management_, &window_management_listener_, NULL);
+  connectSignals();
+}
+
+/* static */ void KdeWindowManager::connectSignals() {
   connect(KdeWindowManager::self(), &KdeWindowManager::activeWindowChanged,
       WindowSystem::self(), &WindowSystem::activeWindowChanged);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowAdded,
@@ -54,6 +82,8 @@ bool KdeWindowManager::showingDesktop_;
       WindowSystem::self(), &WindowSystem::windowStateChanged);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowTitleChanged,
       WindowSystem::self(), &WindowSystem::windowTitleChanged);
+  connect(KdeWindowManager::self(), &KdeWindowManager::windowIconChanged,
+      WindowSystem::self(), &WindowSystem::windowIconChanged);
 }
 
 /* static */ void KdeWindowManager::bindWindowManagerFunctions(
@@ -181,12 +211,106 @@ bool KdeWindowManager::showingDesktop_;
   }
 }
 
+/* static */ void KdeWindowManager::fetchIcon(struct org_kde_plasma_window* window) {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+    std::cerr << "Could not create pipe to fetch window icon" << std::endl;
+    return;
+  }
+
+  // Any previous fetch for the same window is superseded.
+  auto fetch = std::make_unique<IconFetch>();
+  fetch->fd = fds[0];
+  fetch->mapping_order = windows_[window]->mapping_order;
+  fetch->notifier = std::make_unique<QSocketNotifier>(fds[0], QSocketNotifier::Read);
+  connect(fetch->notifier.get(), &QSocketNotifier::activated, self(), [window] {
+    readIconData(window);
+  });
+  iconFetches_[window] = std::move(fetch);
+
+  // libwayland duplicates the fd when marshalling, so we can close the write end right away.
+  org_kde_plasma_window_get_icon(window, fds[1]);
+  close(fds[1]);
+
+  auto app = dynamic_cast<QGuiApplication*>(QGuiApplication::instance());
+  auto waylandApp = app ? app->nativeInterface<QNativeInterface::QWaylandApplication>() : nullptr;
+  if (waylandApp && waylandApp->display()) {
+    wl_display_flush(waylandApp->display());
+  }
+}
+
+/* static */ void KdeWindowManager::readIconData(struct org_kde_plasma_window* window) {
+  if (iconFetches_.count(window) == 0) {
+    return;
+  }
+
+  auto& fetch = iconFetches_[window];
+  char buffer[65536];
+  while (true) {
+    const ssize_t n = read(fetch->fd, buffer, sizeof(buffer));
+    if (n > 0) {
+      fetch->data.append(buffer, n);
+      if (fetch->data.size() > kMaxIconDataSize) {
+        std::cerr << "Window icon data is too large" << std::endl;
+        iconFetches_.erase(window);
+        return;
+      }
+    } else if (n == 0) {
+      break;  // EOF: the compositor has written the whole icon.
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return;  // Wait for more data.
+    } else {
+      std::cerr << "Could not read window icon data" << std::endl;
+      iconFetches_.erase(window);
+      return;
+    }
+  }
+
+  const uint32_t mapping_order = fetch->mapping_order;
+  const std::string appId = windows_.count(window) > 0 ? windows_[window]->appId : "";
+  QByteArray data = std::move(fetch->data);
+  iconFetches_.erase(window);
+
+  // Decoded on the GUI thread, as a QIcon may go through the icon theme engine.
+  QDataStream stream(data);
+  QIcon icon;
+  stream >> icon;
+  if (!icon.isNull()) {
+    setIconImage(window, mapping_order, appId, icon.pixmap(kIconSize).toImage());
+  }
+}
+
+/* static */ void KdeWindowManager::setIconImage(
+    struct org_kde_plasma_window* window, uint32_t mapping_order, const std::string& appId,
+    const QImage& image) {
+  if (image.isNull()) {
+    return;
+  }
+
+  if (!appId.empty()) {
+    iconCache_[appId] = image;
+  }
+
+  // The window might have been unmapped (and its handle reused) while reading.
+  if (windows_.count(window) == 0 || windows_[window]->mapping_order != mapping_order) {
+    return;
+  }
+
+  windows_[window]->iconImage = image;
+  if (windows_[window]->initialized) {
+    emit self()->windowIconChanged(windows_[window].get());
+  }
+}
+
 // org_kde_plasma_window_management interface.
 
 /* static */ void KdeWindowManager::show_desktop_changed(
     void *data,
     struct org_kde_plasma_window_management *org_kde_plasma_window_management,
     uint32_t state) {
+  WaylandEventTrace::record(WaylandEvent::kKdeShowDesktopChanged, nullptr, state);
   // Ignore and use our own state.
   //showingDesktop_ = state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_SHOW_DESKTOP_ENABLED;
 }
@@ -195,6 +319,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window_management *org_kde_plasma_window_management,
     uint32_t id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeWindow, nullptr, id);
   // Ignore.
 }
 
@@ -202,6 +327,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window_management *org_kde_plasma_window_management,
     struct wl_array *ids) {
+  WaylandEventTrace::record(WaylandEvent::kKdeStackingOrderChanged, nullptr, ids);
   // Ignore.
 }
 
@@ -209,6 +335,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window_management *org_kde_plasma_window_management,
     const char *uuids) {
+  WaylandEventTrace::record(WaylandEvent::kKdeStackingOrderUuidChanged, nullptr, uuids);
   QStringList ids = QString(uuids).split(";", Qt::SkipEmptyParts);
   stackingOrder_.clear();
   for (const auto& id : ids) {
@@ -223,13 +350,19 @@ bool KdeWindowManager::showingDesktop_;
     const char *uuid) {
   struct org_kde_plasma_window* window =
       org_kde_plasma_window_management_get_window_by_uuid(window_management_, uuid);
+  WaylandEventTrace::record(WaylandEvent::kKdeWindowWithUuid, window, id, uuid);
+  addWindow(window, uuid);
+
+  org_kde_plasma_window_add_listener(window, &window_listener_, NULL);
+}
+
+/* static */ void KdeWindowManager::addWindow(
+    struct org_kde_plasma_window* window, const std::string& uuid) {
   windows_[window] = std::make_unique<WindowInfo>();
   windows_[window]->window = window;
   static uint32_t mapping_order = 0;
   windows_[window]->mapping_order = mapping_order++;
-  uuids_[std::string{uuid}] = window;
-
-  org_kde_plasma_window_add_listener(window, &window_listener_, NULL);
+  uuids_[uuid] = window;
 }
 
 // org_kde_plasma_window interface.
@@ -238,6 +371,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *title) {
+  WaylandEventTrace::record(WaylandEvent::kKdeTitleChanged, window, title);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -252,13 +386,14 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *app_id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeAppIdChanged, window, app_id);
   if (windows_.count(window) == 0) {
     return;
   }
 
   windows_[window]->appId = app_id;
 
-  if (std::string(app_id) == "crystal-dock") {
+  if (std::string(app_id) == "crystal-dock" && !WaylandEventTrace::replaying()) {
     org_kde_plasma_window_set_state(
         window,
         ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ON_ALL_DESKTOPS |
@@ -272,6 +407,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     uint32_t flags) {
+  WaylandEventTrace::record(WaylandEvent::kKdeStateChanged, window, flags);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -298,6 +434,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     int32_t number) {
+  WaylandEventTrace::record(WaylandEvent::kKdeVirtualDesktopChanged, window, number);
   // Ignore.
 }
 
@@ -305,6 +442,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *name) {
+  WaylandEventTrace::record(WaylandEvent::kKdeThemedIconNameChanged, window, name);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -315,22 +453,25 @@ bool KdeWindowManager::showingDesktop_;
 /* static */ void KdeWindowManager::unmapped(
     void *data,
     struct org_kde_plasma_window* window) {
+  WaylandEventTrace::record(WaylandEvent::kKdeUnmapped, window);
   if (windows_.count(window) == 0) {
     return;
   }
 
   emit self()->windowRemoved(windows_[window]->window);
+  iconFetches_.erase(window);
   windows_.erase(window);
 }
 
 /* static */ void KdeWindowManager::initial_state(
     void *data, struct org_kde_plasma_window* window) {
+  WaylandEventTrace::record(WaylandEvent::kKdeInitialState, window);
   if (windows_.count(window) == 0) {
     return;
   }
 
   windows_[window]->initialized = true;
-  if (!windows_[window]->skipTaskbar) {
+  if (!windows_[window]->skipTaskbar && !WindowSystem::loadingInitialWindows()) {
     emit self()->windowAdded(windows_[window].get());
   }
 }
@@ -339,7 +480,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     struct org_kde_plasma_window *parent) {
-
+  WaylandEventTrace::record(WaylandEvent::kKdeParentWindow, window, parent);
 }
 
 /* static */ void KdeWindowManager::geometry(
@@ -349,6 +490,7 @@ bool KdeWindowManager::showingDesktop_;
     int32_t y,
     uint32_t width,
     uint32_t height) {
+  WaylandEventTrace::record(WaylandEvent::kKdeGeometry, window, x, y, width, height);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -364,17 +506,51 @@ bool KdeWindowManager::showingDesktop_;
 
 /* static */ void KdeWindowManager::icon_changed(
     void *data,
-    struct org_kde_plasma_window* window) {}
+    struct org_kde_plasma_window* window) {
+  WaylandEventTrace::record(WaylandEvent::kKdeIconChanged, window);
+  if (windows_.count(window) == 0) {
+    return;
+  }
+
+  const auto& appId = windows_[window]->appId;
+  if (!windows_[window]->iconImage.isNull()) {
+    // The application has updated its icon.
+    iconCache_.erase(appId);
+  }
+
+  // The themed icon takes precedence, so the icon data is only needed if there
+  // is no themed icon or it is not in the icon theme.
+  const auto& iconName = windows_[window]->icon;
+  if (!iconName.empty() && !loadCachedIcon(QString::fromStdString(iconName)).isNull()) {
+    return;
+  }
+
+  // Other windows of the same application usually share the same icon.
+  if (windows_[window]->iconImage.isNull() && iconCache_.count(appId) > 0) {
+    windows_[window]->iconImage = iconCache_[appId];
+    if (windows_[window]->initialized) {
+      emit self()->windowIconChanged(windows_[window].get());
+    }
+    return;
+  }
+
+  if (!WaylandEventTrace::replaying()) {
+    fetchIcon(window);
+  }
+}
 
 /* static */ void KdeWindowManager::pid_changed(
     void *data,
     struct org_kde_plasma_window* window,
-    uint32_t pid) {}
+    uint32_t pid) {
+  WaylandEventTrace::record(WaylandEvent::kKdePidChanged, window, pid);
+}
 
 /* static */ void KdeWindowManager::virtual_desktop_entered(
     void *data,
     struct org_kde_plasma_window* window,
     const char *id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeVirtualDesktopEntered, window, id);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -385,6 +561,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeVirtualDesktopLeft, window, id);
   if (id != WindowSystem::currentDesktop()) {
     return;
   }
@@ -400,12 +577,16 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *service_name,
-    const char *object_path) {}
+    const char *object_path) {
+  WaylandEventTrace::record(
+      WaylandEvent::kKdeApplicationMenu, window, service_name, object_path);
+}
 
 /* static */ void KdeWindowManager::activity_entered(
     void *data,
     struct org_kde_plasma_window* window,
     const char *id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeActivityEntered, window, id);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -417,6 +598,7 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window* window,
     const char *id) {
+  WaylandEventTrace::record(WaylandEvent::kKdeActivityLeft, window, id);
   if (id != WindowSystem::currentActivity()) {
     return;
   }
@@ -431,6 +613,8 @@ bool KdeWindowManager::showingDesktop_;
 /* static */ void KdeWindowManager::resource_name_changed(
     void *data,
     struct org_kde_plasma_window* window,
-    const char *resource_name) {}
+    const char *resource_name) {
+  WaylandEventTrace::record(WaylandEvent::kKdeResourceNameChanged, window, resource_name);
+}
 
 }  // namespace crystaldock
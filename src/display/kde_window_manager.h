@@ -22,6 +22,10 @@
 #include <memory>
 #include <string>
 
+#include <QByteArray>
+#include <QImage>
+#include <QSocketNotifier>
+
 #include "plasma_window_management.h"
 #include "window_system.h"
 
@@ -40,12 +44,15 @@ class KdeWindowManager : public QObject {
   void windowGeometryChanged(const WindowInfo*);
   void windowStateChanged(const WindowInfo*);
   void windowTitleChanged(const WindowInfo*);
+  void windowIconChanged(const WindowInfo*);
   void activeWindowChanged(void*);
   void windowLeftCurrentActivity(void*);
 
  public:
   static KdeWindowManager* self();
   static void init(struct org_kde_plasma_window_management* window_management);
+  // Forwards our signals to WindowSystem's.
+  static void connectSignals();
 
   static void bindWindowManagerFunctions(WindowManager* windowManager);
 
@@ -64,6 +71,29 @@ class KdeWindowManager : public QObject {
   static void setShowingDesktop(bool show);
 
  private:
+  // Size of the decoded compositor-provided icons.
+  static constexpr int kIconSize = 128;
+  // Upper bound on the serialized icon data we are willing to read.
+  static constexpr int kMaxIconDataSize = 16 * 1024 * 1024;
+
+  // An in-flight get_icon request, reading the icon data from the read end of a pipe.
+  struct IconFetch {
+    int fd;
+    uint32_t mapping_order;
+    QByteArray data;
+    std::unique_ptr<QSocketNotifier> notifier;
+
+    ~IconFetch();
+  };
+
+  // Requests the pixmap-based icon of the window from the compositor.
+  static void fetchIcon(struct org_kde_plasma_window* window);
+  // Reads available icon data without blocking, decoding it once the compositor closes the pipe.
+  static void readIconData(struct org_kde_plasma_window* window);
+  static void setIconImage(struct org_kde_plasma_window* window, uint32_t mapping_order,
+                           const std::string& appId, const QImage& image);
+
+  static void addWindow(struct org_kde_plasma_window* window, const std::string& uuid);
 
   // org_kde_plasma_window_management interface.
 
@@ -215,6 +245,13 @@ class KdeWindowManager : public QObject {
   static std::vector<std::string> stackingOrder_;
   static struct org_kde_plasma_window* activeWindow_;
   static bool showingDesktop_;
+
+  static std::unordered_map<struct org_kde_plasma_window*, std::unique_ptr<IconFetch>>
+      iconFetches_;
+  // Decoded icons, keyed by app ID.
+  static std::unordered_map<std::string, QImage> iconCache_;
+
+  friend class WaylandEventTrace;
 };
 
 }
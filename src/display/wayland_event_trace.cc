@@ -0,0 +1,388 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wayland_event_trace.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include <QCoreApplication>
+
+#include "kde_window_manager.h"
+#include "wlr_window_manager.h"
+
+namespace crystaldock {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::ofstream traceFile;
+std::unordered_map<const void*, uint64_t> objectIds;
+Clock::time_point lastEventTime;
+
+void writeVarint(uint64_t value) {
+  char buffer[10];
+  int size = 0;
+  while (value >= 0x80) {
+    buffer[size++] = static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  buffer[size++] = static_cast<char>(value);
+  traceFile.write(buffer, size);
+}
+
+void writeBytes(const void* data, size_t size) {
+  writeVarint(size);
+  traceFile.write(static_cast<const char*>(data), size);
+}
+
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+uint64_t objectId(const void* object) {
+  if (object == nullptr) {
+    return 0;
+  }
+  auto it = objectIds.find(object);
+  if (it != objectIds.end()) {
+    return it->second;
+  }
+  const uint64_t id = objectIds.size() + 1;
+  objectIds[object] = id;
+  return id;
+}
+
+// Reads the events of a trace loaded in memory.
+class TraceReader {
+ public:
+  TraceReader(const std::string& data, size_t pos) : data_(data), pos_(pos) {}
+
+  bool atEnd() const { return pos_ >= data_.size(); }
+  bool ok() const { return ok_; }
+
+  uint64_t readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        ok_ = false;
+        return 0;
+      }
+      const auto byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    ok_ = false;
+    return 0;
+  }
+
+  uint8_t readByte() {
+    if (pos_ >= data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  int64_t readInt() {
+    const uint64_t value = readVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  std::string readString() {
+    const uint64_t size = readVarint();
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return "";
+    }
+    std::string value = data_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+  bool ok_ = true;
+};
+
+// Stand-in objects for the protocol objects of the recorded session.
+class ReplayObjects {
+ public:
+  template <typename T>
+  T* get(uint64_t id) {
+    if (id == 0) {
+      return nullptr;
+    }
+    auto& object = objects_[id];
+    if (!object) {
+      // Each object only needs a unique address, it is never dereferenced.
+      object = std::make_unique<char>();
+    }
+    return reinterpret_cast<T*>(object.get());
+  }
+
+ private:
+  std::unordered_map<uint64_t, std::unique_ptr<char>> objects_;
+};
+
+}  // namespace
+
+bool WaylandEventTrace::recording_ = false;
+bool WaylandEventTrace::replaying_ = false;
+
+/* static */ bool WaylandEventTrace::startRecording(const std::string& path) {
+  stopRecording();
+  traceFile.open(path, std::ios::binary | std::ios::trunc);
+  if (!traceFile.is_open()) {
+    std::cerr << "Could not open Wayland event trace file: " << path << std::endl;
+    return false;
+  }
+
+  traceFile.write(kMagic, 4);
+  traceFile.put(static_cast<char>(kVersion));
+  objectIds.clear();
+  lastEventTime = Clock::now();
+  recording_ = true;
+  std::cout << "Recording Wayland events to " << path << std::endl;
+  return true;
+}
+
+/* static */ void WaylandEventTrace::stopRecording() {
+  if (!recording_) {
+    return;
+  }
+  recording_ = false;
+  traceFile.close();
+}
+
+/* static */ void WaylandEventTrace::beginEvent(WaylandEvent event, const void* object) {
+  const auto now = Clock::now();
+  writeVarint(std::chrono::duration_cast<std::chrono::microseconds>(
+      now - lastEventTime).count());
+  lastEventTime = now;
+  traceFile.put(static_cast<char>(event));
+  writeVarint(objectId(object));
+}
+
+/* static */ void WaylandEventTrace::writeArg(int32_t value) {
+  writeVarint(zigzag(value));
+}
+
+/* static */ void WaylandEventTrace::writeArg(uint32_t value) {
+  writeVarint(zigzag(value));
+}
+
+/* static */ void WaylandEventTrace::writeArg(const char* value) {
+  writeBytes(value, value ? strlen(value) : 0);
+}
+
+/* static */ void WaylandEventTrace::writeArg(const wl_array* value) {
+  writeBytes(value->data, value->size);
+}
+
+/* static */ void WaylandEventTrace::writeArg(const void* object) {
+  writeVarint(objectId(object));
+}
+
+/* static */ int64_t WaylandEventTrace::replay(const std::string& path, bool realTime) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Could not open Wayland event trace file: " << path << std::endl;
+    return -1;
+  }
+  const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  if (data.size() < 5 || data.compare(0, 4, kMagic) != 0 ||
+      static_cast<uint8_t>(data[4]) != kVersion) {
+    std::cerr << "Invalid Wayland event trace file: " << path << std::endl;
+    return -1;
+  }
+
+  TraceReader reader(data, /*pos=*/5);
+  ReplayObjects objects;
+  int64_t count = 0;
+  replaying_ = true;
+  while (!reader.atEnd()) {
+    const auto delay = std::chrono::microseconds(reader.readVarint());
+    const auto event = static_cast<WaylandEvent>(reader.readByte());
+    const auto id = reader.readVarint();
+    if (!reader.ok()) {
+      break;
+    }
+
+    if (realTime) {
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(delay);
+    }
+
+    auto* kdeWindow = objects.get<struct org_kde_plasma_window>(id);
+    auto* wlrWindow = objects.get<struct zwlr_foreign_toplevel_handle_v1>(id);
+    switch (event) {
+      case WaylandEvent::kKdeShowDesktopChanged:
+        KdeWindowManager::show_desktop_changed(nullptr, nullptr, reader.readInt());
+        break;
+      case WaylandEvent::kKdeWindow:
+        KdeWindowManager::window(nullptr, nullptr, reader.readInt());
+        break;
+      case WaylandEvent::kKdeStackingOrderChanged: {
+        std::string ids = reader.readString();
+        wl_array array = {ids.size(), ids.size(), ids.data()};
+        KdeWindowManager::stacking_order_changed(nullptr, nullptr, &array);
+        break;
+      }
+      case WaylandEvent::kKdeStackingOrderUuidChanged:
+        KdeWindowManager::stacking_order_uuid_changed(
+            nullptr, nullptr, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeWindowWithUuid: {
+        reader.readInt();  // Deprecated numeric id.
+        KdeWindowManager::addWindow(kdeWindow, reader.readString());
+        break;
+      }
+      case WaylandEvent::kKdeTitleChanged:
+        KdeWindowManager::title_changed(nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeAppIdChanged:
+        KdeWindowManager::app_id_changed(nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeStateChanged:
+        KdeWindowManager::state_changed(nullptr, kdeWindow, reader.readInt());
+        break;
+      case WaylandEvent::kKdeVirtualDesktopChanged:
+        KdeWindowManager::virtual_desktop_changed(nullptr, kdeWindow, reader.readInt());
+        break;
+      case WaylandEvent::kKdeThemedIconNameChanged:
+        KdeWindowManager::themed_icon_name_changed(
+            nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeUnmapped:
+        KdeWindowManager::unmapped(nullptr, kdeWindow);
+        break;
+      case WaylandEvent::kKdeInitialState:
+        KdeWindowManager::initial_state(nullptr, kdeWindow);
+        break;
+      case WaylandEvent::kKdeParentWindow:
+        KdeWindowManager::parent_window(
+            nullptr, kdeWindow, objects.get<struct org_kde_plasma_window>(reader.readVarint()));
+        break;
+      case WaylandEvent::kKdeGeometry: {
+        const auto x = reader.readInt();
+        const auto y = reader.readInt();
+        const auto width = reader.readInt();
+        const auto height = reader.readInt();
+        KdeWindowManager::geometry(nullptr, kdeWindow, x, y, width, height);
+        break;
+      }
+      case WaylandEvent::kKdeIconChanged:
+        KdeWindowManager::icon_changed(nullptr, kdeWindow);
+        break;
+      case WaylandEvent::kKdePidChanged:
+        KdeWindowManager::pid_changed(nullptr, kdeWindow, reader.readInt());
+        break;
+      case WaylandEvent::kKdeVirtualDesktopEntered:
+        KdeWindowManager::virtual_desktop_entered(
+            nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeVirtualDesktopLeft:
+        KdeWindowManager::virtual_desktop_left(nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeApplicationMenu: {
+        const auto serviceName = reader.readString();
+        const auto objectPath = reader.readString();
+        KdeWindowManager::application_menu(
+            nullptr, kdeWindow, serviceName.c_str(), objectPath.c_str());
+        break;
+      }
+      case WaylandEvent::kKdeActivityEntered:
+        KdeWindowManager::activity_entered(nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeActivityLeft:
+        KdeWindowManager::activity_left(nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kKdeResourceNameChanged:
+        KdeWindowManager::resource_name_changed(
+            nullptr, kdeWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kWlrToplevel:
+        WlrWindowManager::addWindow(wlrWindow);
+        break;
+      case WaylandEvent::kWlrFinished:
+        WlrWindowManager::finished(nullptr, nullptr);
+        break;
+      case WaylandEvent::kWlrTitle:
+        WlrWindowManager::title(nullptr, wlrWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kWlrAppId:
+        WlrWindowManager::app_id(nullptr, wlrWindow, reader.readString().c_str());
+        break;
+      case WaylandEvent::kWlrOutputEnter:
+        WlrWindowManager::output_enter(
+            nullptr, wlrWindow, objects.get<struct wl_output>(reader.readVarint()));
+        break;
+      case WaylandEvent::kWlrOutputLeave:
+        WlrWindowManager::output_leave(
+            nullptr, wlrWindow, objects.get<struct wl_output>(reader.readVarint()));
+        break;
+      case WaylandEvent::kWlrState: {
+        std::string states = reader.readString();
+        wl_array array = {states.size(), states.size(), states.data()};
+        WlrWindowManager::state(nullptr, wlrWindow, &array);
+        break;
+      }
+      case WaylandEvent::kWlrDone:
+        WlrWindowManager::done(nullptr, wlrWindow);
+        break;
+      case WaylandEvent::kWlrClosed:
+        WlrWindowManager::closed(nullptr, wlrWindow);
+        break;
+      case WaylandEvent::kWlrParent:
+        WlrWindowManager::parent(
+            nullptr, wlrWindow,
+            objects.get<struct zwlr_foreign_toplevel_handle_v1>(reader.readVarint()));
+        break;
+      default:
+        std::cerr << "Unknown event in Wayland event trace: "
+                  << static_cast<int>(event) << std::endl;
+        replaying_ = false;
+        return -1;
+    }
+
+    if (!reader.ok()) {
+      break;
+    }
+    ++count;
+  }
+  replaying_ = false;
+
+  if (!reader.ok()) {
+    std::cerr << "Truncated Wayland event trace file: " << path << std::endl;
+  }
+  QCoreApplication::processEvents();
+  return count;
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_WAYLAND_EVENT_TRACE_H_
+#define CRYSTALDOCK_WAYLAND_EVENT_TRACE_H_
+
+#include <cstdint>
+#include <string>
+
+#include <wayland-client.h>
+
+namespace crystaldock {
+
+// Window management protocol events that can be recorded and replayed.
+// The values are part of the trace format, so only append new ones.
+enum class WaylandEvent : uint8_t {
+  // org_kde_plasma_window_management interface.
+  kKdeShowDesktopChanged = 1,
+  kKdeWindow,
+  kKdeStackingOrderChanged,
+  kKdeStackingOrderUuidChanged,
+  kKdeWindowWithUuid,
+
+  // org_kde_plasma_window interface.
+  kKdeTitleChanged,
+  kKdeAppIdChanged,
+  kKdeStateChanged,
+  kKdeVirtualDesktopChanged,
+  kKdeThemedIconNameChanged,
+  kKdeUnmapped,
+  kKdeInitialState,
+  kKdeParentWindow,
+  kKdeGeometry,
+  kKdeIconChanged,
+  kKdePidChanged,
+  kKdeVirtualDesktopEntered,
+  kKdeVirtualDesktopLeft,
+  kKdeApplicationMenu,
+  kKdeActivityEntered,
+  kKdeActivityLeft,
+  kKdeResourceNameChanged,
+
+  // zwlr_foreign_toplevel_manager_v1 interface.
+  kWlrToplevel,
+  kWlrFinished,
+
+  // zwlr_foreign_toplevel_handle_v1 interface.
+  kWlrTitle,
+  kWlrAppId,
+  kWlrOutputEnter,
+  kWlrOutputLeave,
+  kWlrState,
+  kWlrDone,
+  kWlrClosed,
+  kWlrParent,
+};
+
+// Records incoming window management events to a compact binary trace and
+// replays a trace through the same static handlers without a compositor.
+//
+// Trace format: the magic "CDWT" and a version byte, followed by one record
+// per event: the time since the previous event in microseconds (varint),
+// the event code (byte), the id of the receiving object (varint) and the
+// event arguments. Integers are zigzag varints, strings and arrays are
+// length-prefixed and objects are ids that are assigned in order of first
+// appearance.
+class WaylandEventTrace {
+ public:
+  // Starts recording to the file at `path`, overwriting it.
+  static bool startRecording(const std::string& path);
+  static void stopRecording();
+  static bool recording() { return recording_; }
+
+  // Whether the events are being replayed, in which case the handlers must
+  // not send any requests since there is no compositor.
+  static bool replaying() { return replaying_; }
+
+  template <typename... Args>
+  static void record(WaylandEvent event, const void* object, const Args&... args) {
+    if (!recording_) {
+      return;
+    }
+    beginEvent(event, object);
+    (writeArg(args), ...);
+  }
+
+  // Replays the trace at `path`. If `realTime` is true, the original timing
+  // between events is preserved and the Qt event loop is run in-between,
+  // otherwise the events are dispatched back to back.
+  // Returns the number of replayed events, or -1 on error.
+  static int64_t replay(const std::string& path, bool realTime = false);
+
+ private:
+  static constexpr char kMagic[] = "CDWT";
+  static constexpr uint8_t kVersion = 1;
+
+  static void beginEvent(WaylandEvent event, const void* object);
+
+  static void writeArg(int32_t value);
+  static void writeArg(uint32_t value);
+  static void writeArg(const char* value);
+  static void writeArg(const wl_array* value);
+  // Object arguments, e.g. outputs and parent windows.
+  static void writeArg(const void* object);
+
+  static bool recording_;
+  static bool replaying_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_WAYLAND_EVENT_TRACE_H_
@@ -0,0 +1,186 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wayland_event_trace.h"
+
+#include <map>
+#include <string>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "fake_window_manager.h"
+#include "kde_window_manager.h"
+#include "window_system.h"
+#include "wlr_window_manager.h"
+
+namespace crystaldock {
+
+class WaylandEventTraceTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+
+  void recordAndReplay();
+  void replay_invalidHeader();
+
+ private:
+  void writeFile(const QString& path, const QByteArray& content) {
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+  }
+
+  // The window signals received during the replay, e.g. "removed Terminal".
+  QStringList signals_;
+  // The titles of the added windows, by handle.
+  std::map<const void*, QString> titles_;
+};
+
+void WaylandEventTraceTest::initTestCase() {
+  // The fake backend provides the virtual desktops, with "desktop-1" as the current one.
+  FakeWindowManager::init(2);
+  KdeWindowManager::connectSignals();
+  WlrWindowManager::connectSignals();
+
+  auto* windowSystem = WindowSystem::self();
+  connect(windowSystem, &WindowSystem::windowAdded, this, [this](const WindowInfo* info) {
+    titles_[info->window] = QString::fromStdString(info->title);
+    signals_.append(QString("added %1 %2 (%3,%4 %5x%6) %7").arg(
+        QString::fromStdString(info->appId), titles_[info->window]).arg(info->x).arg(info->y)
+        .arg(info->width).arg(info->height).arg(QString::fromStdString(info->desktop)));
+  });
+  connect(windowSystem, &WindowSystem::windowRemoved, this, [this](void* window) {
+    signals_.append("removed " + titles_[window]);
+  });
+  connect(windowSystem, &WindowSystem::windowTitleChanged, this, [this](const WindowInfo* info) {
+    signals_.append("title " + QString::fromStdString(info->title));
+  });
+  connect(windowSystem, &WindowSystem::windowGeometryChanged, this,
+          [this](const WindowInfo* info) {
+    signals_.append(QString("geometry (%1,%2 %3x%4)").arg(info->x).arg(info->y)
+        .arg(info->width).arg(info->height));
+  });
+  connect(windowSystem, &WindowSystem::windowStateChanged, this, [this](const WindowInfo* info) {
+    signals_.append(QString("state minimized=%1").arg(info->minimized ? 1 : 0));
+  });
+  connect(windowSystem, &WindowSystem::activeWindowChanged, this, [this](void* window) {
+    signals_.append("active " + titles_[window]);
+  });
+  connect(windowSystem, &WindowSystem::windowLeftCurrentDesktop, this, [this](void* window) {
+    signals_.append("left desktop " + titles_[window]);
+  });
+  connect(windowSystem, &WindowSystem::windowEnteredOutput, this,
+          [this](const WindowInfo* info, const wl_output*) {
+    signals_.append(QString("entered output maximized=%1").arg(info->maximized ? 1 : 0));
+  });
+}
+
+void WaylandEventTraceTest::recordAndReplay() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const std::string path = (dir.path() + "/trace").toStdString();
+
+  // Stand-ins for the protocol objects, only their addresses are recorded.
+  int dolphin, dialog, konsole, output;
+  QVERIFY(WaylandEventTrace::startRecording(path));
+
+  WaylandEventTrace::record(WaylandEvent::kKdeWindowWithUuid, &dolphin, uint32_t(1), "uuid-1");
+  WaylandEventTrace::record(WaylandEvent::kKdeAppIdChanged, &dolphin, "org.kde.dolphin");
+  WaylandEventTrace::record(WaylandEvent::kKdeTitleChanged, &dolphin, "Home — Dolphin");
+  WaylandEventTrace::record(WaylandEvent::kKdeGeometry, &dolphin, int32_t(-10), int32_t(20),
+                            uint32_t(800), uint32_t(600));
+  WaylandEventTrace::record(WaylandEvent::kKdeVirtualDesktopEntered, &dolphin, "desktop-2");
+  WaylandEventTrace::record(WaylandEvent::kKdeInitialState, &dolphin);
+  WaylandEventTrace::record(WaylandEvent::kKdeStateChanged, &dolphin,
+                            uint32_t(ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE));
+  WaylandEventTrace::record(WaylandEvent::kKdeTitleChanged, &dolphin, "Documents — Dolphin");
+  WaylandEventTrace::record(WaylandEvent::kKdeGeometry, &dolphin, int32_t(100), int32_t(-50),
+                            uint32_t(1024), uint32_t(768));
+  WaylandEventTrace::record(WaylandEvent::kKdeVirtualDesktopLeft, &dolphin, "desktop-1");
+
+  WaylandEventTrace::record(WaylandEvent::kKdeWindowWithUuid, &dialog, uint32_t(2), "uuid-2");
+  WaylandEventTrace::record(WaylandEvent::kKdeTitleChanged, &dialog, "Copying");
+  WaylandEventTrace::record(WaylandEvent::kKdeParentWindow, &dialog,
+                            static_cast<const void*>(&dolphin));
+  WaylandEventTrace::record(WaylandEvent::kKdeInitialState, &dialog);
+  WaylandEventTrace::record(WaylandEvent::kKdeUnmapped, &dialog);
+  WaylandEventTrace::record(WaylandEvent::kKdeStackingOrderUuidChanged, nullptr,
+                            "uuid-1;uuid-2");
+
+  uint32_t states[] = {ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED,
+                       ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED};
+  wl_array stateArray = {sizeof(states), sizeof(states), states};
+  WaylandEventTrace::record(WaylandEvent::kWlrToplevel, &konsole);
+  WaylandEventTrace::record(WaylandEvent::kWlrTitle, &konsole, "Terminal");
+  WaylandEventTrace::record(WaylandEvent::kWlrAppId, &konsole, "org.kde.konsole");
+  WaylandEventTrace::record(WaylandEvent::kWlrState, &konsole, &stateArray);
+  WaylandEventTrace::record(WaylandEvent::kWlrOutputEnter, &konsole,
+                            static_cast<const void*>(&output));
+  WaylandEventTrace::record(WaylandEvent::kWlrDone, &konsole);
+  WaylandEventTrace::record(WaylandEvent::kWlrClosed, &konsole);
+  WaylandEventTrace::stopRecording();
+
+  signals_.clear();
+  QCOMPARE(WaylandEventTrace::replay(path), int64_t(23));
+  QCOMPARE(signals_, QStringList({
+      "added org.kde.dolphin Home — Dolphin (-10,20 800x600) desktop-2",
+      "active Home — Dolphin",
+      "state minimized=0",
+      "title Documents — Dolphin",
+      "geometry (100,-50 1024x768)",
+      "left desktop Home — Dolphin",
+      "added  Copying (0,0 0x0) ",
+      "removed Copying",
+      "entered output maximized=1",
+      "added org.kde.konsole Terminal (0,0 0x0) ",
+      "removed Terminal",
+  }));
+
+  const auto windows = KdeWindowManager::windows();
+  QCOMPARE(windows.size(), size_t(1));
+  QCOMPARE(windows[0]->title, std::string("Documents — Dolphin"));
+  QCOMPARE(windows[0]->desktop, std::string("desktop-2"));
+  QVERIFY(WlrWindowManager::windows().empty());
+}
+
+void WaylandEventTraceTest::replay_invalidHeader() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.path() + "/trace";
+
+  QCOMPARE(WaylandEventTrace::replay(path.toStdString()), int64_t(-1));  // Missing.
+  writeFile(path, QByteArray("CDWX\x01", 5));
+  QCOMPARE(WaylandEventTrace::replay(path.toStdString()), int64_t(-1));
+  writeFile(path, QByteArray("CDWT\x02", 5));
+  QCOMPARE(WaylandEventTrace::replay(path.toStdString()), int64_t(-1));
+  writeFile(path, QByteArray("CDWT", 4));
+  QCOMPARE(WaylandEventTrace::replay(path.toStdString()), int64_t(-1));
+
+  writeFile(path, QByteArray("CDWT\x01", 5));
+  QCOMPARE(WaylandEventTrace::replay(path.toStdString()), int64_t(0));
+}
+
+}  // namespace crystaldock
+
+QTEST_GUILESS_MAIN(crystaldock::WaylandEventTraceTest)
+#include "wayland_event_trace_test.moc"
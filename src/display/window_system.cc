@@ -4,7 +4,10 @@
 #include <iostream>
 #include <string>
 
-#include <QDBusReply>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QGuiApplication>
 
 #include <LayerShellQt/Shell>
@@ -13,6 +16,7 @@
 #include "kde_auto_hide_manager.h"
 #include "kde_virtual_desktop_manager.h"
 #include "kde_window_manager.h"
+#include "wayland_event_trace.h"
 #include "wlr_window_manager.h"
 
 namespace crystaldock {
@@ -42,7 +46,9 @@ WindowManager WindowSystem::windowManager_;
 AutoHideManager WindowSystem::autoHideManager_;
 
 std::vector<QScreen*> WindowSystem::screens_;
-std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
+struct wl_display* WindowSystem::display_;
+int WindowSystem::initialWindowsSyncs_;
+bool WindowSystem::hasActivityManager_;
 
 /* static */ WindowSystem* WindowSystem::self() {
   static WindowSystem self;
@@ -50,6 +56,11 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 }
 
 /* static */ bool WindowSystem::init(struct wl_display* display) {
+  const auto tracePath = qEnvironmentVariable("CRYSTAL_DOCK_WAYLAND_TRACE");
+  if (!tracePath.isEmpty()) {
+    WaylandEventTrace::startRecording(tracePath.toStdString());
+  }
+
   struct wl_registry *registry = wl_display_get_registry(display);
   wl_registry_add_listener(registry, &registry_listener_, NULL);
 
@@ -81,25 +92,30 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 
   LayerShellQt::Shell::useLayerShell();
 
-  activityManager_ = std::make_unique<QDBusInterface>(
-      "org.kde.ActivityManager", "/ActivityManager/Activities",
-      "org.kde.ActivityManager.Activities");
-  if (activityManager_->isValid()) {
-    const QDBusReply<QString> reply = activityManager_->call("CurrentActivity");
-    if (reply.isValid()) {
-      WindowSystem::self()->setCurrentActivity(reply.value().toStdString());
-    }
-    connect(activityManager_.get(), SIGNAL(CurrentActivityChanged(QString)),
-            WindowSystem::self(), SLOT(onCurrentActivityChanged(QString)));
-  }
+  // The initial windows are ingested as one batch once the compositor has sent them all.
+  display_ = display;
+  initialWindowsSyncs_ = 2;
+  syncInitialWindows();
+
+  initActivityManager();
 
   initScreens();
 
   return true;
 }
 
+/* static */ void WindowSystem::initWithoutCompositor(
+    void (*bindWindowManagerFunctions)(WindowManager*),
+    void (*bindVirtualDesktopManagerFunctions)(VirtualDesktopManager*)) {
+  bindWindowManagerFunctions(&windowManager_);
+  if (bindVirtualDesktopManagerFunctions) {
+    bindVirtualDesktopManagerFunctions(&virtualDesktopManager_);
+  }
+  initScreens();
+}
+
 /* static */ bool WindowSystem::hasVirtualDesktopManager() {
-  return kde_virtual_desktop_management_ != nullptr;
+  return virtualDesktopManager_.numberOfDesktops != nullptr;
 }
 
 /* static */ bool WindowSystem::hasAutoHideManager() {
@@ -107,7 +123,38 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 }
 
 /* static */ bool WindowSystem::hasActivityManager() {
-  return activityManager_->isValid();
+  return hasActivityManager_;
+}
+
+/* static */ void WindowSystem::syncInitialWindows() {
+  // The first round trip delivers the new windows, the second one the initial states
+  // of the windows created in response (for the KDE backend).
+  struct wl_callback* callback = wl_display_sync(display_);
+  wl_callback_add_listener(callback, &initial_windows_sync_listener_, NULL);
+}
+
+/* static */ void WindowSystem::initActivityManager() {
+  static constexpr char kService[] = "org.kde.ActivityManager";
+  static constexpr char kPath[] = "/ActivityManager/Activities";
+  static constexpr char kInterface[] = "org.kde.ActivityManager.Activities";
+
+  auto message = QDBusMessage::createMethodCall(kService, kPath, kInterface, "CurrentActivity");
+  auto* watcher = new QDBusPendingCallWatcher(
+      QDBusConnection::sessionBus().asyncCall(message), self());
+  connect(watcher, &QDBusPendingCallWatcher::finished, self(),
+          [](QDBusPendingCallWatcher* call) {
+    QDBusPendingReply<QString> reply = *call;
+    call->deleteLater();
+    if (reply.isError()) {
+      return;  // No activity manager, e.g. not on KDE.
+    }
+
+    hasActivityManager_ = true;
+    QDBusConnection::sessionBus().connect(
+        kService, kPath, kInterface, "CurrentActivityChanged",
+        self(), SLOT(onCurrentActivityChanged(QString)));
+    self()->onCurrentActivityChanged(reply.value());
+  });
 }
 
 /* static */ void WindowSystem::setAnchorAndStrut(
@@ -165,6 +212,19 @@ void WindowSystem::initScreens() {
   return nullptr;
 }
 
+// wl_callback interface.
+
+/* static */ void WindowSystem::initial_windows_sync_done(
+    void* data, struct wl_callback* callback, uint32_t callback_data) {
+  wl_callback_destroy(callback);
+  if (--initialWindowsSyncs_ > 0) {
+    syncInitialWindows();
+    return;
+  }
+
+  emit self()->initialWindowsLoaded();
+}
+
 // wl_registry interface.
 
 /* static */ void WindowSystem::registry_global(
@@ -27,7 +27,7 @@
 
 #include <wayland-client.h>
 
-#include <QDBusInterface>
+#include <QImage>
 #include <QObject>
 #include <QPixmap>
 #include <QRect>
@@ -59,6 +59,8 @@ struct WindowInfo {
   std::string appId;
   std::string title;
   std::string icon;
+  // Pixmap-based icon provided by the compositor, used when there is no themed icon name.
+  QImage iconImage;
   std::string desktop;
   std::string activity;
   bool initialized;
@@ -79,7 +81,7 @@ struct WindowInfo {
 
 struct VirtualDesktopManager {
   int (*numberOfDesktops)();
-  std::vector<VirtualDesktopInfo> (*desktops)();
+  const std::vector<VirtualDesktopInfo>& (*desktops)();
   std::string_view (*currentDesktop)();
   void (*setCurrentDesktop)(std::string_view);
 };
@@ -115,12 +117,17 @@ class WindowSystem : public QObject {
   void numberOfDesktopsChanged(int);
   void desktopNameChanged(std::string_view desktopId, std::string_view desktopName);
 
+  // Emitted once the initial set of windows has been received from the compositor,
+  // instead of windowAdded() for each of them.
+  void initialWindowsLoaded();
+
   void windowAdded(const WindowInfo*);
   void windowRemoved(void*);
   void windowLeftCurrentDesktop(void*);
   void windowGeometryChanged(const WindowInfo*);
   void windowStateChanged(const WindowInfo*);
   void windowTitleChanged(const WindowInfo*);
+  void windowIconChanged(const WindowInfo*);
   void activeWindowChanged(void*);
   void windowLeftCurrentActivity(void*);
 
@@ -147,11 +154,20 @@ class WindowSystem : public QObject {
  public:
   static WindowSystem* self();
   static bool init(struct wl_display* display);
+  // Binds the given backend functions without connecting to a compositor,
+  // e.g. when replaying a recorded Wayland event trace or benchmarking with a fake backend.
+  static void initWithoutCompositor(
+      void (*bindWindowManagerFunctions)(WindowManager*),
+      void (*bindVirtualDesktopManagerFunctions)(VirtualDesktopManager*) = nullptr);
 
   static bool hasVirtualDesktopManager();
   static bool hasAutoHideManager();
   static bool hasActivityManager();
 
+  // Whether the initial set of windows is still being received, during which
+  // the backends don't emit windowAdded().
+  static bool loadingInitialWindows() { return initialWindowsSyncs_ > 0; }
+
   static int numberOfDesktops() {
     if (hasVirtualDesktopManager()) {
       return virtualDesktopManager_.numberOfDesktops();
@@ -159,11 +175,12 @@ class WindowSystem : public QObject {
     return 1;
   }
 
-  static std::vector<VirtualDesktopInfo> desktops() {
+  static const std::vector<VirtualDesktopInfo>& desktops() {
     if (hasVirtualDesktopManager()) {
       return virtualDesktopManager_.desktops();
     }
-    return {};
+    static const std::vector<VirtualDesktopInfo> kNoDesktops;
+    return kNoDesktops;
   }
 
   static std::string_view currentDesktop() {
@@ -239,6 +256,20 @@ class WindowSystem : public QObject {
       registry_global_remove
   };
 
+  // wl_callback interface, used to detect the end of the initial window snapshot.
+
+  static void initial_windows_sync_done(void* data,
+                                        struct wl_callback* callback,
+                                        uint32_t callback_data);
+
+  static constexpr struct wl_callback_listener initial_windows_sync_listener_ = {
+      initial_windows_sync_done
+  };
+
+  static void syncInitialWindows();
+
+  static void initActivityManager();
+
 
   static void initScreens();
 
@@ -254,7 +285,11 @@ class WindowSystem : public QObject {
 
   static std::vector<QScreen*> screens_;
 
-  static std::unique_ptr<QDBusInterface> activityManager_;
+  static struct wl_display* display_;
+  // Number of sync round trips left before the initial window snapshot is complete.
+  static int initialWindowsSyncs_;
+
+  static bool hasActivityManager_;
 };
 
 }  // namespace crystaldock
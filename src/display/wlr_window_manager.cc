@@ -22,6 +22,8 @@
 
 #include <QGuiApplication>
 
+#include "wayland_event_trace.h"
+
 namespace crystaldock {
 
 zwlr_foreign_toplevel_manager_v1* WlrWindowManager::window_manager_;
@@ -42,6 +44,10 @@ bool WlrWindowManager::showingDesktop_;
   window_manager_ = window_manager;
   zwlr_foreign_toplevel_manager_v1_add_listener(
       window_manager_, &window_manager_listener_, NULL);
+  connectSignals();
+}
+
+/* static */ void WlrWindowManager::connectSignals() {
   connect(WlrWindowManager::self(), &WlrWindowManager::activeWindowChanged,
       WindowSystem::self(), &WindowSystem::activeWindowChanged);
   connect(WlrWindowManager::self(), &WlrWindowManager::windowAdded,
@@ -184,17 +190,24 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_manager_v1 *zwlr_foreign_toplevel_manager_v1,
     struct zwlr_foreign_toplevel_handle_v1 *window) {
+  WaylandEventTrace::record(WaylandEvent::kWlrToplevel, window);
+  addWindow(window);
+
+  zwlr_foreign_toplevel_handle_v1_add_listener(window, &window_listener_, NULL);
+}
+
+/* static */ void WlrWindowManager::addWindow(struct zwlr_foreign_toplevel_handle_v1* window) {
   windows_[window] = std::make_unique<WindowInfo>();
   windows_[window]->window = window;
   static uint32_t mapping_order = 0;
   windows_[window]->mapping_order = mapping_order++;
-
-  zwlr_foreign_toplevel_handle_v1_add_listener(window, &window_listener_, NULL);
 }
 
 /* static */ void WlrWindowManager::finished(
     void *data,
-    struct zwlr_foreign_toplevel_manager_v1 *zwlr_foreign_toplevel_manager_v1) {}
+    struct zwlr_foreign_toplevel_manager_v1 *zwlr_foreign_toplevel_manager_v1) {
+  WaylandEventTrace::record(WaylandEvent::kWlrFinished, nullptr);
+}
 
 // zwlr_foreign_toplevel_handle_v1 interface.
 
@@ -202,6 +215,7 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
     const char *title) {
+  WaylandEventTrace::record(WaylandEvent::kWlrTitle, window, title);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -216,6 +230,7 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
     const char *app_id) {
+  WaylandEventTrace::record(WaylandEvent::kWlrAppId, window, app_id);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -227,6 +242,7 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
     struct wl_output *output) {
+  WaylandEventTrace::record(WaylandEvent::kWlrOutputEnter, window, output);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -239,6 +255,7 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
     struct wl_output *output) {
+  WaylandEventTrace::record(WaylandEvent::kWlrOutputLeave, window, output);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -251,6 +268,7 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
     struct wl_array *state) {
+  WaylandEventTrace::record(WaylandEvent::kWlrState, window, state);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -304,17 +322,21 @@ bool WlrWindowManager::showingDesktop_;
 /* static */ void WlrWindowManager::done(
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window) {
+  WaylandEventTrace::record(WaylandEvent::kWlrDone, window);
   if (windows_.count(window) == 0) {
     return;
   }
 
   windows_[window]->initialized = true;
-  emit self()->windowAdded(windows_[window].get());
+  if (!WindowSystem::loadingInitialWindows()) {
+    emit self()->windowAdded(windows_[window].get());
+  }
 }
 
 /* static */ void WlrWindowManager::closed(
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window) {
+  WaylandEventTrace::record(WaylandEvent::kWlrClosed, window);
   if (windows_.count(window) == 0) {
     return;
   }
@@ -326,6 +348,8 @@ bool WlrWindowManager::showingDesktop_;
 /* static */ void WlrWindowManager::parent(
     void *data,
     struct zwlr_foreign_toplevel_handle_v1 *window,
-    struct zwlr_foreign_toplevel_handle_v1 *parent) {}
+    struct zwlr_foreign_toplevel_handle_v1 *parent) {
+  WaylandEventTrace::record(WaylandEvent::kWlrParent, window, parent);
+}
 
 }  // namespace crystaldock
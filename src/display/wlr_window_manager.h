@@ -49,6 +49,8 @@ class WlrWindowManager : public QObject {
  public:
   static WlrWindowManager* self();
   static void init(struct zwlr_foreign_toplevel_manager_v1* window_manager);
+  // Forwards our signals to WindowSystem's.
+  static void connectSignals();
 
   static void bindWindowManagerFunctions(WindowManager* windowManager);
 
@@ -67,6 +69,7 @@ class WlrWindowManager : public QObject {
   static void setShowingDesktop(bool show);
 
  private:
+  static void addWindow(struct zwlr_foreign_toplevel_handle_v1* window);
 
   // zwlr_foreign_toplevel_manager_v1 interface.
 
@@ -143,6 +146,8 @@ class WlrWindowManager : public QObject {
   // So when we show desktop on/off we can restore the active window.
   static struct zwlr_foreign_toplevel_handle_v1* activeWindowBeforeShowDesktop_;
   static bool showingDesktop_;
+
+  friend class WaylandEventTrace;
 };
 
 }
@@ -0,0 +1,202 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "application_menu_cache.h"
+
+#include <sys/stat.h>
+
+#include <iostream>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace crystaldock {
+
+namespace {
+
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0;
+
+QDataStream& operator<<(QDataStream& out, const FileStamp& stamp) {
+  return out << static_cast<qint64>(stamp.mtime) << static_cast<qint64>(stamp.size);
+}
+
+QDataStream& operator>>(QDataStream& in, FileStamp& stamp) {
+  qint64 mtime, size;
+  in >> mtime >> size;
+  stamp.mtime = mtime;
+  stamp.size = size;
+  return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const ParsedDesktopEntry& entry) {
+  return out << entry.appId << entry.name << entry.unlocalizedName << entry.genericName
+             << entry.icon << entry.command << entry.wmClass << entry.categories
+             << entry.keywords << entry.file << entry.hidden;
+}
+
+QDataStream& operator>>(QDataStream& in, ParsedDesktopEntry& entry) {
+  return in >> entry.appId >> entry.name >> entry.unlocalizedName >> entry.genericName
+            >> entry.icon >> entry.command >> entry.wmClass >> entry.categories
+            >> entry.keywords >> entry.file >> entry.hidden;
+}
+
+}  // namespace
+
+/* static */ FileStamp FileStamp::of(const QString& path) {
+  struct stat buffer;
+  if (stat(QFile::encodeName(path).constData(), &buffer) != 0) {
+    return {};
+  }
+  return {static_cast<int64_t>(buffer.st_mtim.tv_sec) * 1000000000 + buffer.st_mtim.tv_nsec,
+          static_cast<int64_t>(buffer.st_size)};
+}
+
+/* static */ QString ApplicationMenuCache::getCacheFile() {
+  return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+      + "/crystal-dock/application-menu.cache";
+}
+
+bool ApplicationMenuCache::load(const QString& key) {
+  clear();
+
+  if (cacheFile_.isEmpty()) {
+    return false;
+  }
+
+  QFile file(cacheFile_);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+    return false;
+  }
+  uchar* data = file.map(0, file.size());
+  if (data == nullptr) {
+    return false;
+  }
+
+  // Reads straight from the mapped file without copying it.
+  const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data),
+                                                   file.size());
+  QDataStream in(bytes);
+  in.setVersion(kStreamVersion);
+  quint32 magic, version;
+  QString cachedKey;
+  in >> magic >> version;
+  if (magic != kMagic || version != kVersion) {
+    file.unmap(data);
+    return false;
+  }
+  in >> cachedKey;
+  if (cachedKey != key) {
+    file.unmap(data);
+    return false;
+  }
+
+  quint32 numDirs;
+  in >> numDirs;
+  for (quint32 i = 0; i < numDirs && in.status() == QDataStream::Ok; ++i) {
+    QString path;
+    CachedDir dir;
+    in >> path >> dir.stamp >> dir.fileNames;
+    dirs_[path] = dir;
+  }
+
+  quint32 numFiles;
+  in >> numFiles;
+  for (quint32 i = 0; i < numFiles && in.status() == QDataStream::Ok; ++i) {
+    QString path;
+    CachedFile cachedFile;
+    bool isApplication;
+    in >> path >> cachedFile.stamp >> isApplication;
+    if (isApplication) {
+      ParsedDesktopEntry entry;
+      in >> entry;
+      cachedFile.entry = entry;
+    }
+    files_[path] = cachedFile;
+  }
+
+  const bool ok = (in.status() == QDataStream::Ok);
+  file.unmap(data);
+  if (!ok) {
+    std::cerr << "Corrupted application menu cache: " << cacheFile_.toStdString() << std::endl;
+    clear();
+  }
+  return ok;
+}
+
+bool ApplicationMenuCache::save(const QString& key) const {
+  if (cacheFile_.isEmpty()) {
+    return false;
+  }
+
+  QDir().mkpath(QFileInfo(cacheFile_).absolutePath());
+  QSaveFile file(cacheFile_);
+  if (!file.open(QIODevice::WriteOnly)) {
+    std::cerr << "Could not write application menu cache: " << cacheFile_.toStdString()
+              << std::endl;
+    return false;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(kStreamVersion);
+  out << static_cast<quint32>(kMagic) << static_cast<quint32>(kVersion) << key;
+  out << static_cast<quint32>(dirs_.size());
+  for (auto it = dirs_.begin(); it != dirs_.end(); ++it) {
+    out << it.key() << it->stamp << it->fileNames;
+  }
+  out << static_cast<quint32>(files_.size());
+  for (auto it = files_.begin(); it != files_.end(); ++it) {
+    out << it.key() << it->stamp << it->entry.has_value();
+    if (it->entry) {
+      out << *it->entry;
+    }
+  }
+  return file.commit();
+}
+
+const QStringList* ApplicationMenuCache::fileNames(const QString& dir,
+                                                   const FileStamp& stamp) const {
+  auto it = dirs_.find(dir);
+  return (it != dirs_.end() && it->stamp == stamp) ? &it->fileNames : nullptr;
+}
+
+void ApplicationMenuCache::setFileNames(const QString& dir, const FileStamp& stamp,
+                                        const QStringList& fileNames) {
+  dirs_[dir] = {stamp, fileNames};
+}
+
+const ApplicationMenuCache::CachedFile* ApplicationMenuCache::file(
+    const QString& path, const FileStamp& stamp) const {
+  auto it = files_.find(path);
+  return (it != files_.end() && it->stamp == stamp) ? &(*it) : nullptr;
+}
+
+void ApplicationMenuCache::setFile(const QString& path, const CachedFile& file) {
+  files_[path] = file;
+}
+
+void ApplicationMenuCache::clear() {
+  dirs_.clear();
+  files_.clear();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,100 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_APPLICATION_MENU_CACHE_H_
+#define CRYSTALDOCK_APPLICATION_MENU_CACHE_H_
+
+#include <cstdint>
+#include <optional>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "application_menu_entry.h"
+
+namespace crystaldock {
+
+// Modification time (in nanoseconds) and size of a file or directory.
+struct FileStamp {
+  int64_t mtime = -1;
+  int64_t size = -1;
+
+  bool operator==(const FileStamp& other) const = default;
+
+  // Returns the stamp of the file at `path`, or an invalid one if it does not exist.
+  static FileStamp of(const QString& path);
+  bool valid() const { return mtime >= 0; }
+};
+
+// Persistent binary index of parsed desktop entries, so that a warm start only
+// needs to parse the desktop files that have changed.
+//
+// Directories are validated by their modification time, which changes when
+// files are added, removed or renamed, and individual files by their
+// modification time and size.
+class ApplicationMenuCache {
+ public:
+  // A cached desktop file. `entry` is empty if the file is not an application.
+  struct CachedFile {
+    FileStamp stamp;
+    std::optional<ParsedDesktopEntry> entry;
+  };
+
+  explicit ApplicationMenuCache(const QString& cacheFile) : cacheFile_(cacheFile) {}
+
+  // $XDG_CACHE_HOME/crystal-dock/application-menu.cache
+  static QString getCacheFile();
+
+  // Loads the cache file by memory-mapping it. `key` identifies the settings the
+  // entries were parsed with (e.g. the desktop environment), the cache is
+  // discarded if it does not match. Returns false if there is no valid cache.
+  bool load(const QString& key);
+
+  // Writes the cache file atomically. Does nothing if there is no cache file.
+  bool save(const QString& key) const;
+
+  // Returns the cached file names of the directory if it has not changed, or nullptr.
+  const QStringList* fileNames(const QString& dir, const FileStamp& stamp) const;
+  void setFileNames(const QString& dir, const FileStamp& stamp, const QStringList& fileNames);
+
+  // Returns the cached file if it has not changed, or nullptr.
+  const CachedFile* file(const QString& path, const FileStamp& stamp) const;
+  void setFile(const QString& path, const CachedFile& file);
+
+  int numFiles() const { return files_.size(); }
+
+  void clear();
+
+ private:
+  static constexpr uint32_t kMagic = 0x43444d43;  // "CDMC"
+  static constexpr uint32_t kVersion = 3;
+
+  struct CachedDir {
+    FileStamp stamp;
+    QStringList fileNames;
+  };
+
+  QString cacheFile_;
+  QHash<QString, CachedDir> dirs_;
+  QHash<QString, CachedFile> files_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_APPLICATION_MENU_CACHE_H_
@@ -20,11 +20,19 @@
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <numeric>
+#include <tuple>
 
 #include <QApplication>
+#include <QCollator>
+#include <QCollatorSortKey>
 #include <QDir>
 #include <QFileInfo>
+#include <QLocale>
 #include <QStringBuilder>
+#include <QThread>
+#include <QThreadPool>
 #include <QUrl>
 
 #include <utils/command_utils.h>
@@ -34,12 +42,11 @@ namespace crystaldock {
 
 namespace {
 
-bool isHidden(const DesktopFile& desktopFile) {
+bool isHidden(const DesktopFile& desktopFile, const QString& desktopEnvName) {
   if (desktopFile.noDisplay() || desktopFile.hidden()) {
     return true;
   }
 
-  QString desktopEnvName = DesktopEnv::getDesktopEnvName();
   // Some desktop files still use the legacy "X-Desktop" name.
   if (!desktopFile.showOnDesktop(desktopEnvName) &&
       !desktopFile.showOnDesktop("X-" + desktopEnvName)) {
@@ -59,19 +66,39 @@ bool isHidden(const DesktopFile& desktopFile) {
   return false;
 }
 
+// Total order over all the fields of an entry, for diffing.
+bool lessByFields(const ApplicationEntry& e1, const ApplicationEntry& e2) {
+  return std::tie(e1.name, e1.appId, e1.genericName, e1.icon, e1.command, e1.desktopFile,
+                  e1.hidden) <
+         std::tie(e2.name, e2.appId, e2.genericName, e2.icon, e2.command, e2.desktopFile,
+                  e2.hidden);
+}
+
 }  // namespace
 
-ApplicationMenuConfig::ApplicationMenuConfig(const QStringList& entryDirs)
+ApplicationMenuConfig::ApplicationMenuConfig(const QStringList& entryDirs,
+                                             const QString& cacheFile)
     : entryDirs_(entryDirs),
+      cache_(cacheFile),
       fileWatcher_(entryDirs),
       desktopEnv_(DesktopEnv::getDesktopEnv()) {
   initCategories();
   initSystemCategories();
+  cache_.load(getCacheKey());
   loadEntries();
+  reloadTimer_.setSingleShot(true);
+  reloadTimer_.setInterval(kReloadDelayMs);
+  connect(&reloadTimer_, SIGNAL(timeout()), this, SLOT(reload()));
   connect(&fileWatcher_, SIGNAL(directoryChanged(const QString&)),
-          this, SLOT(reload()));
+          &reloadTimer_, SLOT(start()));
   connect(&fileWatcher_, SIGNAL(fileChanged(const QString&)),
-          this, SLOT(reload()));
+          &reloadTimer_, SLOT(start()));
+}
+
+/* static */ QString ApplicationMenuConfig::getCacheKey() {
+  // Parsed entries depend on the desktop environment (hidden entries) and
+  // the locale (localized names).
+  return DesktopEnv::getDesktopEnvName() + ";" + QLocale::system().name();
 }
 
 QStringList ApplicationMenuConfig::getEntryDirs() {
@@ -119,6 +146,7 @@ void ApplicationMenuConfig::initCategories() {
 
 void ApplicationMenuConfig::initSystemCategories() {
   systemCategories_ = desktopEnv_->getApplicationMenuSystemCategories();
+  addSystemAliases();
 }
 
 void ApplicationMenuConfig::clearEntries() {
@@ -126,177 +154,308 @@ void ApplicationMenuConfig::clearEntries() {
     category.entries.clear();
   }
   entries_.clear();
-  shortAppIds_.clear();
-  wmClasses_.clear();
-  names_.clear();
+  aliases_.clear();
+  addSystemAliases();
 }
 
 bool ApplicationMenuConfig::loadEntries() {
+  // Only the directories and files that have changed since they were cached are read.
+  const QString desktopEnvName = DesktopEnv::getDesktopEnvName();
+  ApplicationMenuCache updatedCache = cache_;
+  updatedCache.clear();
+  bool cacheChanged = false;
+
+  QStringList files;
+  std::vector<FileStamp> stamps;
+  std::vector<std::optional<ParsedDesktopEntry>> parsedEntries;
+  std::vector<int> filesToParse;
   for (const QString& entryDir : entryDirs_) {
-    if (!QDir::root().exists(entryDir)) {
+    const auto dirStamp = FileStamp::of(entryDir);
+    if (!dirStamp.valid()) {
       continue;
     }
 
-    QDir dir(entryDir);
-    QStringList files = dir.entryList({"*.desktop"}, QDir::Files, QDir::Name);
-    if (files.isEmpty()) {
-      continue;
+    const QStringList* cachedFileNames = cache_.fileNames(entryDir, dirStamp);
+    const QStringList fileNames = cachedFileNames
+        ? *cachedFileNames : QDir(entryDir).entryList({"*.desktop"}, QDir::Files, QDir::Name);
+    cacheChanged |= (cachedFileNames == nullptr);
+    updatedCache.setFileNames(entryDir, dirStamp, fileNames);
+
+    for (const auto& fileName : fileNames) {
+      const QString file = entryDir + "/" + fileName;
+      const auto stamp = FileStamp::of(file);
+      const auto* cachedFile = cache_.file(file, stamp);
+      if (cachedFile) {
+        parsedEntries.push_back(cachedFile->entry);
+      } else {
+        parsedEntries.emplace_back();
+        filesToParse.push_back(files.size());
+      }
+      files.append(file);
+      stamps.push_back(stamp);
+    }
+  }
+
+  // Parses the changed files in parallel, then merges all entries in order,
+  // as the first entry of an app ID wins.
+  const int numFilesToParse = filesToParse.size();
+  const int numTasks = (numFilesToParse < kMinFilesForParallelLoading)
+      ? 1 : std::min(QThread::idealThreadCount(), numFilesToParse);
+  if (numTasks <= 1) {
+    for (int i : filesToParse) {
+      parsedEntries[i] = parseEntry(files.at(i), desktopEnvName);
+    }
+  } else {
+    auto parseSlice = [&](int task) {
+      for (int j = task; j < numFilesToParse; j += numTasks) {
+        const int i = filesToParse[j];
+        parsedEntries[i] = parseEntry(files.at(i), desktopEnvName);
+      }
+    };
+    // A dedicated pool, as the global one may be busy with other work (e.g.
+    // searches) while this thread is waiting. This thread parses the first slice.
+    QThreadPool pool;
+    pool.setMaxThreadCount(numTasks - 1);
+    for (int task = 1; task < numTasks; ++task) {
+      pool.start([&parseSlice, task] { parseSlice(task); });
     }
+    parseSlice(0);
+    pool.waitForDone();
+  }
 
-    for (int i = 0; i < files.size(); ++i) {
-      const QString& file = entryDir + "/" + files.at(i);
-      loadEntry(file);
+  for (int i = 0; i < files.size(); ++i) {
+    updatedCache.setFile(files.at(i), {stamps[i], parsedEntries[i]});
+  }
+  cacheChanged |= (numFilesToParse > 0 || updatedCache.numFiles() != cache_.numFiles());
+  cache_ = std::move(updatedCache);
+  if (cacheChanged) {
+    cache_.save(getCacheKey());
+  }
+
+  // Entries don't move once the categories are sorted, so the look-up maps are
+  // built afterwards, in the order the entries were added.
+  std::vector<AddedEntry> addedEntries;
+  for (const auto& parsedEntry : parsedEntries) {
+    if (parsedEntry) {
+      addEntry(*parsedEntry, &addedEntries);
+    }
+  }
+  const auto positions = sortEntries();
+  auto searchIndex = std::make_shared<ApplicationSearchIndex>();
+  for (const auto& added : addedEntries) {
+    const auto& entry = categories_[added.category].entries[
+        positions[added.category][added.index]];
+    indexEntry(&entry, *added.parsedEntry);
+    if (!entry.hidden) {
+      searchIndex->add(entry, added.parsedEntry->keywords);
     }
   }
+  addSpecialCaseAliases();
+  searchIndex_ = std::move(searchIndex);
+  searchState_ = {};
 
   return true;
 }
 
-bool ApplicationMenuConfig::loadEntry(const QString &file) {
+/* static */ std::optional<ParsedDesktopEntry> ApplicationMenuConfig::parseEntry(
+    const QString& file, const QString& desktopEnvName) {
   DesktopFile desktopFile(file);
 
   if (desktopFile.type() != "Application") {
-    return false;
+    return std::nullopt;
   }
 
-  auto categories = desktopFile.categories();
-  if (categories.isEmpty()) {
-    categories = {kUncategorized};
+  ParsedDesktopEntry parsedEntry;
+  parsedEntry.appId = desktopFile.appId();
+  parsedEntry.name = desktopFile.name();
+  parsedEntry.unlocalizedName = desktopFile.unlocalizedName();
+  parsedEntry.genericName = desktopFile.genericName();
+  parsedEntry.icon = desktopFile.icon();
+  parsedEntry.command = filterFieldCodes(desktopFile.exec().simplified());
+  parsedEntry.wmClass = desktopFile.wmClass();
+  parsedEntry.categories = desktopFile.categories();
+  parsedEntry.keywords = desktopFile.keywords();
+  if (parsedEntry.categories.isEmpty()) {
+    parsedEntry.categories = {kUncategorized};
   }
+  parsedEntry.file = file;
+  parsedEntry.hidden = isHidden(desktopFile, desktopEnvName);
+  return parsedEntry;
+}
 
-  const QString appId = desktopFile.appId();
-  for (int i = 0; i < categories.size(); ++i) {
-    const std::string category = categories[i].toStdString();
-    if (categoryMap_.count(category) > 0 &&
-        entries_.count(appId.toStdString()) == 0) {
-      const QString command = filterFieldCodes(desktopFile.exec().simplified());
-      ApplicationEntry newEntry(appId,
-                                desktopFile.name(),
-                                desktopFile.genericName(),
-                                desktopFile.icon(),
-                                command,
-                                file,
-                                isHidden(desktopFile));
-      auto& entries = categories_[categoryMap_[category]].entries;
-      auto next = std::lower_bound(entries.begin(), entries.end(), newEntry);
-      entries.insert(next, newEntry);
-
-      auto* entry = &(*--next);
-      const auto appId = newEntry.appId.toLower();
-      entries_[appId.toStdString()] = entry;
-      auto shortAppId = appId.simplified().replace(" ", "");
-      shortAppId = shortAppId.mid(shortAppId.lastIndexOf('.') + 1);
-      shortAppIds_[shortAppId.toStdString()] = entry;
-      const auto shortCommand = getShortCommand(command).toLower().toStdString();
-      if (!shortCommand.empty()) {
-        commands_[shortCommand] = entry;
-      }
-      const auto wmClass =
-          desktopFile.wmClass().toLower().simplified().replace(" ", "").toStdString();
-      if (!wmClass.empty()) {
-        wmClasses_[wmClass] = entry;
-      }
-      const auto name = desktopFile.name().toLower().simplified().replace(" ", "").toStdString();
-      if (!name.empty()) {
-        names_[name] = entry;
-      }
+void ApplicationMenuConfig::addEntry(const ParsedDesktopEntry& parsedEntry,
+                                     std::vector<AddedEntry>* addedEntries) {
+  // An entry is only added to the first of its known categories.
+  const auto appId = parsedEntry.appId.toLower().toStdString();
+  if (entries_.count(appId) > 0) {
+    return;
+  }
+  for (const auto& category : parsedEntry.categories) {
+    auto it = categoryMap_.find(category.toStdString());
+    if (it != categoryMap_.end()) {
+      auto& entries = categories_[it->second].entries;
+      entries.emplace_back(parsedEntry.appId,
+                           parsedEntry.name,
+                           parsedEntry.genericName,
+                           parsedEntry.icon,
+                           parsedEntry.command,
+                           parsedEntry.file,
+                           parsedEntry.hidden);
+      // Set by indexEntry() once the entry has its final position.
+      entries_[appId] = nullptr;
+      addedEntries->push_back({it->second, static_cast<int>(entries.size()) - 1, &parsedEntry});
+      return;
     }
   }
+}
 
-  return true;
+std::vector<std::vector<int>> ApplicationMenuConfig::sortEntries() {
+  QCollator collator;
+  collator.setCaseSensitivity(Qt::CaseInsensitive);
+  std::vector<std::vector<int>> positions(categories_.size());
+  for (size_t i = 0; i < categories_.size(); ++i) {
+    auto& entries = categories_[i].entries;
+    const int numEntries = entries.size();
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(numEntries);
+    for (const auto& entry : entries) {
+      keys.push_back(collator.sortKey(entry.name));
+    }
+    std::vector<int> order(numEntries);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](int e1, int e2) {
+      return keys[e1].compare(keys[e2]) < 0;
+    });
+
+    std::vector<ApplicationEntry> sortedEntries;
+    sortedEntries.reserve(numEntries);
+    positions[i].resize(numEntries);
+    for (int j = 0; j < numEntries; ++j) {
+      sortedEntries.push_back(std::move(entries[order[j]]));
+      positions[i][order[j]] = j;
+    }
+    entries = std::move(sortedEntries);
+  }
+  return positions;
 }
 
-void ApplicationMenuConfig::reload() {
-  clearEntries();
-  loadEntries();
-  emit configChanged();
+void ApplicationMenuConfig::indexEntry(const ApplicationEntry* entry,
+                                       const ParsedDesktopEntry& parsedEntry) {
+  const auto appId = entry->appId.toLower();
+  entries_[appId.toStdString()] = entry;
+  addAlias(appId, entry, AliasType::AppId);
+  auto shortAppId = appId.simplified().replace(" ", "");
+  shortAppId = shortAppId.mid(shortAppId.lastIndexOf('.') + 1);
+  addAlias(shortAppId, entry, AliasType::ShortAppId);
+  addAlias(getShortCommand(entry->command).toLower(), entry, AliasType::Command);
+  addAlias(parsedEntry.wmClass.toLower().simplified().replace(" ", ""), entry,
+           AliasType::WmClass);
+  // The localized name would make the matching depend on the locale.
+  addAlias(parsedEntry.unlocalizedName.toLower().simplified().replace(" ", ""), entry,
+           AliasType::Name);
 }
 
-const ApplicationEntry* ApplicationMenuConfig::findApplication(const std::string& appId) const {
+void ApplicationMenuConfig::addAlias(const QString& alias, const ApplicationEntry* entry,
+                                     AliasType type) {
+  if (alias.isEmpty()) {
+    return;
+  }
+
+  auto [it, inserted] = aliases_.try_emplace(alias.toStdString(), Alias{entry, type});
+  // Among aliases of the same type, the last one wins.
+  if (!inserted && type <= it->second.type) {
+    it->second = {entry, type};
+  }
+}
+
+void ApplicationMenuConfig::addSystemAliases() {
   for (const auto& category : systemCategories_) {
     for (const auto& entry : category.entries) {
-      if (entry.appId.toStdString() == appId) {
-        return &entry;
-      }
+      addAlias(entry.appId, &entry, AliasType::SystemAppId);
     }
   }
-  return entries_.count(appId) > 0
-      ? entries_.at(appId)
-      : shortAppIds_.count(appId) > 0
-          ? shortAppIds_.at(appId)
-          : commands_.count(appId) > 0
-              ? commands_.at(appId)
-              : wmClasses_.count(appId) > 0
-                  ? wmClasses_.at(appId)
-                  : names_.count(appId) > 0
-                      ? names_.at(appId)
-                      : nullptr;
 }
 
-const ApplicationEntry* ApplicationMenuConfig::tryMatchingApplicationId(
-    const std::string& appId) const {
-  QString id = QString::fromStdString(appId).toLower();
-  if (auto* app = findApplication(id.toStdString())) {
-    return app;
+void ApplicationMenuConfig::addSpecialCaseAliases() {
+  static const char* const kSpecialCases[][2] = {
+    // Alias, app ID.
+    // Qt6 D-Bus Viewer.
+    {"qdbusviewer", "org.qt.qdbusviewer6"},
+    // VirtualBox.
+    {"virtualboxvm", "virtualbox"},
+    {"virtualboxmachine", "virtualbox"},
+    {"virtualboxmanager", "virtualbox"},
+    // Google Chrome Flatpak.
+    {"google-chrome", "com.google.chrome"},
+  };
+  for (const auto& specialCase : kSpecialCases) {
+    if (const auto* entry = findApplication(specialCase[1])) {
+      addAlias(specialCase[0], entry, AliasType::SpecialCase);
+    }
   }
+}
 
-  id = id.simplified().replace(" ", "");
-  if (auto* app = findApplication(id.toStdString())) {
-    return app;
+void ApplicationMenuConfig::reload() {
+  // Only the changed files are re-parsed, the rest come from the cache.
+  std::vector<std::vector<ApplicationEntry>> oldEntries;
+  oldEntries.reserve(categories_.size());
+  for (auto& category : categories_) {
+    oldEntries.push_back(std::move(category.entries));
   }
+  clearEntries();
+  loadEntries();
 
-  id = id.mid(id.lastIndexOf('.') + 1);
-  if (auto* app = findApplication(id.toStdString())) {
-    return app;
+  const auto delta = diffEntries(oldEntries);
+  if (!delta.empty()) {
+    emit entriesChanged(delta);
   }
+  emit configChanged();
+}
 
-  // Special fix for Qt6 D-Bus Viewer.
-  if (id == "qdbusviewer") {
-    if (auto* app = findApplication("org.qt.qdbusviewer6")) {
-      return app;
+ApplicationMenuDelta ApplicationMenuConfig::diffEntries(
+    const std::vector<std::vector<ApplicationEntry>>& oldEntries) const {
+  ApplicationMenuDelta delta;
+  for (size_t i = 0; i < categories_.size(); ++i) {
+    auto before = oldEntries[i];
+    auto after = categories_[i].entries;
+    std::sort(before.begin(), before.end(), lessByFields);
+    std::sort(after.begin(), after.end(), lessByFields);
+
+    ApplicationMenuDelta::CategoryDelta categoryDelta{categories_[i].name, {}, {}};
+    std::set_difference(before.begin(), before.end(), after.begin(), after.end(),
+                        std::back_inserter(categoryDelta.removed), lessByFields);
+    std::set_difference(after.begin(), after.end(), before.begin(), before.end(),
+                        std::back_inserter(categoryDelta.added), lessByFields);
+    if (!categoryDelta.removed.empty() || !categoryDelta.added.empty()) {
+      delta.categories.push_back(std::move(categoryDelta));
     }
   }
+  return delta;
+}
 
-  // Special fix for VirtualBox.
-  if (id == "virtualboxvm" || id == "virtualboxmachine" || id == "virtualboxmanager") {
-    if (auto* app = findApplication("virtualbox")) {
-      return app;
-    }
+const ApplicationEntry* ApplicationMenuConfig::tryMatchingApplicationId(
+    const std::string& appId) const {
+  QString id = QString::fromStdString(appId).toLower();
+  if (auto* app = findApplication(id.toStdString())) {
+    return app;
   }
 
-  // Special fix for Google Chrome Flatpak.
-  if (id == "google-chrome") {
-    if (auto* app = findApplication("com.google.chrome")) {
+  const auto simplifiedId = id.simplified().replace(" ", "");
+  if (simplifiedId != id) {
+    id = simplifiedId;
+    if (auto* app = findApplication(id.toStdString())) {
       return app;
     }
   }
 
-  return nullptr;
+  // The special cases are in the alias table too.
+  const auto dot = id.lastIndexOf('.');
+  return (dot >= 0) ? findApplication(id.mid(dot + 1).toStdString()) : nullptr;
 }
 
 const std::vector<ApplicationEntry> ApplicationMenuConfig::searchApplications(
     const QString& text, unsigned int maxNumResults) const {
-  std::vector<ApplicationEntry> entries;
-  for (const auto& category : categories_) {
-    for (const auto& entry : category.entries) {
-      if (text.length() == 1) {
-        if (entry.name.startsWith(text, Qt::CaseInsensitive)) {
-          entries.push_back(entry);
-        }
-      } else {
-        if (entry.name.contains(text, Qt::CaseInsensitive) ||
-            entry.genericName.contains(text, Qt::CaseInsensitive)) {
-          entries.push_back(entry);
-        }
-      }
-      if (entries.size() == maxNumResults) {
-        goto end_loop;
-      }
-    }
-  }
-end_loop:
-  std::sort(entries.begin(), entries.end());
-  return entries;
+  return searchIndex_->search(text, maxNumResults, &searchState_);
 }
 
 }  // namespace crystaldock
@@ -19,7 +19,8 @@
 #ifndef CRYSTALDOCK_APPLICATION_MENU_CONFIG_H_
 #define CRYSTALDOCK_APPLICATION_MENU_CONFIG_H_
 
-#include <list>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,8 +31,11 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QTimer>
 
+#include "application_menu_cache.h"
 #include "application_menu_entry.h"
+#include "application_search_index.h"
 #include <desktop/desktop_env.h>
 
 namespace crystaldock {
@@ -42,7 +46,9 @@ class ApplicationMenuConfig : public QObject {
  public:
   static constexpr char kUncategorized[] = "Uncategorized";
 
-  ApplicationMenuConfig(const QStringList& entryDirs = getEntryDirs());
+  // Parsed entries are cached in `cacheFile`, an empty path disables caching.
+  ApplicationMenuConfig(const QStringList& entryDirs = getEntryDirs(),
+                        const QString& cacheFile = ApplicationMenuCache::getCacheFile());
 
   ~ApplicationMenuConfig() = default;
 
@@ -51,10 +57,13 @@ class ApplicationMenuConfig : public QObject {
   const std::vector<Category>& categories() const { return categories_; }
   const std::vector<Category>& systemCategories() const { return systemCategories_; }
 
-  // Finds the application entry given the application ID.
-  // Will match with each of App ID, short command, WM Class and Name in the
-  // entry list in that order.
-  const ApplicationEntry* findApplication(const std::string& appId) const;
+  // Finds the application entry given the normalized application ID, with a
+  // single look-up in the alias table. Will match with each of App ID, short
+  // App ID, short command, WM Class and Name in that order.
+  const ApplicationEntry* findApplication(const std::string& appId) const {
+    auto it = aliases_.find(appId);
+    return (it != aliases_.end()) ? it->second.entry : nullptr;
+  }
 
   bool isAppMenuEntry(const std::string& appId) const {
     return entries_.count(appId) > 0;
@@ -63,17 +72,50 @@ class ApplicationMenuConfig : public QObject {
   // Tries to find a matching application ID using different heuristics.
   const ApplicationEntry* tryMatchingApplicationId(const std::string& appId) const;
 
-  // Searches for applications with the name containing the given text.
+  // The search index of the current entries, which can be used from any thread.
+  std::shared_ptr<const ApplicationSearchIndex> searchIndex() const { return searchIndex_; }
+
+  // Searches for applications matching the given text, best matches first.
+  // Searching again with a longer text only searches the previous matches.
   const std::vector<ApplicationEntry> searchApplications(
       const QString& text, unsigned int maxNumResults) const;
 
  signals:
+  // Emitted with the changed entries, if any, on reload.
+  void entriesChanged(const ApplicationMenuDelta& delta);
+  // Emitted on every reload, as all entries are reallocated.
   void configChanged();
 
  public slots:
   void reload();
 
  private:
+  // Identifies the settings that the cached entries were parsed with.
+  static QString getCacheKey();
+
+  // Below this number of files, parsing in parallel is not worth it.
+  static constexpr int kMinFilesForParallelLoading = 32;
+
+  // The kinds of aliases of an entry, in the order they are matched.
+  enum class AliasType {
+    SystemAppId, AppId, ShortAppId, Command, WmClass, Name, SpecialCase
+  };
+
+  struct Alias {
+    const ApplicationEntry* entry;
+    AliasType type;
+  };
+
+  // An entry added to a category while loading, in the order of addition.
+  struct AddedEntry {
+    int category;
+    int index;
+    const ParsedDesktopEntry* parsedEntry;
+  };
+
+  // Coalesces the bursts of file system changes from e.g. package upgrades.
+  static constexpr int kReloadDelayMs = 500;
+
   // Initializes application categories.
   void initCategories();
 
@@ -86,8 +128,30 @@ class ApplicationMenuConfig : public QObject {
   // Loads application entries from entryDir.
   bool loadEntries();
 
-  // Loads an application entry from the .desktop file.
-  bool loadEntry(const QString& file);
+  // Parses an application entry from the .desktop file. Thread-safe.
+  static std::optional<ParsedDesktopEntry> parseEntry(const QString& file,
+                                                      const QString& desktopEnvName);
+
+  // Adds a parsed application entry to its category, unsorted.
+  void addEntry(const ParsedDesktopEntry& parsedEntry, std::vector<AddedEntry>* addedEntries);
+
+  // Sorts the entries of each category by name, using precomputed collation
+  // keys. Returns the new positions of the entries in each category.
+  std::vector<std::vector<int>> sortEntries();
+
+  // Adds a sorted entry to the look-up maps.
+  void indexEntry(const ApplicationEntry* entry, const ParsedDesktopEntry& parsedEntry);
+
+  // Adds an alias, unless there is one of a type that is matched first.
+  void addAlias(const QString& alias, const ApplicationEntry* entry, AliasType type);
+
+  // Adds the aliases of the system entries and the known special cases.
+  void addSystemAliases();
+  void addSpecialCaseAliases();
+
+  // Computes the changes from the entries of each category before a reload.
+  ApplicationMenuDelta diffEntries(
+      const std::vector<std::vector<ApplicationEntry>>& oldEntries) const;
 
   // The directories that contains the list of all application entries as
   // desktop files, e.g. /usr/share/applications
@@ -102,17 +166,19 @@ class ApplicationMenuConfig : public QObject {
   std::unordered_map<std::string, int> categoryMap_;
   // Map from app ids to application entries for fast look-up.
   std::unordered_map<std::string, const ApplicationEntry*> entries_;
-  // Map from a short-form app ids to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> shortAppIds_;
-  // Map from short commands to application entries for fast look-up.
-  // Short command means for example, "command" instead of "/usr/bin/command -a -b"
-  std::unordered_map<std::string, const ApplicationEntry*> commands_;
-  // Map from WM classes to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> wmClasses_;
-  // Map from names to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> names_;
+  // Map from all normalized forms of app ids, commands, WM classes and names
+  // to application entries, so that matching is a single look-up.
+  std::unordered_map<std::string, Alias> aliases_;
+
+  // Rebuilt on every load.
+  std::shared_ptr<const ApplicationSearchIndex> searchIndex_;
+  mutable ApplicationSearchIndex::SearchState searchState_;
+
+  // Parsed entries of the desktop files currently loaded.
+  ApplicationMenuCache cache_;
 
   QFileSystemWatcher fileWatcher_;
+  QTimer reloadTimer_;
 
   DesktopEnv* desktopEnv_;
 
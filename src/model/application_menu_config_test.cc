@@ -18,9 +18,13 @@
 
 #include "application_menu_config.h"
 
+#include <tuple>
 #include <unordered_map>
 
+#include <QFile>
+#include <QStandardPaths>
 #include <QString>
+#include <QStringList>
 #include <QTemporaryDir>
 #include <QTest>
 
@@ -33,13 +37,22 @@ class ApplicationMenuConfigTest: public QObject {
   Q_OBJECT
 
  private slots:
+  void initTestCase() {
+    // Keeps the tests from writing to the user's application menu cache.
+    QStandardPaths::setTestModeEnabled(true);
+  }
+
   void init() {
     QTemporaryDir configDir;
   }
 
   void loadEntries_singleDir();
   void loadEntries_multipleDirs();
+  void loadEntries_cache();
+  void loadEntries_mixedCaseAppId();
+  void reload_delta();
   void tryMatchingApplicationId();
+  void searchApplications();
 
  private:
 
@@ -65,6 +78,8 @@ class ApplicationMenuConfigTest: public QObject {
         desktopFile.setNotShowIn(QString::fromStdString(entry.second));
       } else if (entry.first == "StartupWMClass") {
         desktopFile.setWMClass(QString::fromStdString(entry.second));
+      } else if (entry.first == "Keywords") {
+        desktopFile.setKeywords(QString::fromStdString(entry.second));
       }
     }
     desktopFile.write(filename);
@@ -158,6 +173,124 @@ void ApplicationMenuConfigTest::loadEntries_multipleDirs() {
   }
 }
 
+void ApplicationMenuConfigTest::loadEntries_cache() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+  QTemporaryDir cacheDir;
+  QVERIFY(cacheDir.isValid());
+  const QString cacheFile = cacheDir.path() + "/application-menu.cache";
+  writeEntry(entryDir.path() + "/chrome.desktop",
+             {"chrome", "Chrome", "Web Browser", "chrome", "chrome", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/gimp.desktop",
+             {"gimp", "GIMP", "Image Editor", "gimp", "gimp", ""},
+             "Graphics",
+             {{"StartupWMClass", "gimp-2.10"}});
+
+  {
+    ApplicationMenuConfig config({ entryDir.path() }, cacheFile);
+    QCOMPARE(config.entries_.size(), 2);
+  }
+  QVERIFY(QFile::exists(cacheFile));
+
+  // Warm start, served from the cache.
+  {
+    ApplicationMenuConfig config({ entryDir.path() }, cacheFile);
+    QCOMPARE(config.entries_.size(), 2);
+    QVERIFY(config.tryMatchingApplicationId("Gimp-2.10"));
+    QCOMPARE(config.tryMatchingApplicationId("Gimp-2.10")->appId, "gimp");
+    QCOMPARE(config.entries_.at("chrome")->name, "Chrome");
+  }
+
+  // Changed and removed files are picked up.
+  writeEntry(entryDir.path() + "/chrome.desktop",
+             {"chrome", "Google Chrome", "Web Browser", "chrome", "chrome", ""},
+             "Network");
+  QVERIFY(QFile::remove(entryDir.path() + "/gimp.desktop"));
+  {
+    ApplicationMenuConfig config({ entryDir.path() }, cacheFile);
+    QCOMPARE(config.entries_.size(), 1);
+    QCOMPARE(config.entries_.at("chrome")->name, "Google Chrome");
+  }
+}
+
+void ApplicationMenuConfigTest::loadEntries_mixedCaseAppId() {
+  // The two files are in different dirs, so which one comes first only
+  // depends on the order of the dirs.
+  QTemporaryDir entryDir1;
+  QVERIFY(entryDir1.isValid());
+  QTemporaryDir entryDir2;
+  QVERIFY(entryDir2.isValid());
+  const QString systemFile = entryDir1.path() + "/org.kde.Dolphin.desktop";
+  writeEntry(systemFile,
+             {"org.kde.Dolphin", "Dolphin", "File Manager", "system-file-manager", "dolphin", ""},
+             "System;Utility");
+  const QString utilityFile = entryDir2.path() + "/org.kde.dolphin.desktop";
+  writeEntry(utilityFile,
+             {"org.kde.dolphin", "Dolphin", "File Manager", "system-file-manager", "dolphin", ""},
+             "Utility");
+
+  // App IDs that only differ in case are the same app, so only the entry from
+  // the first dir is added, to the first of its known categories.
+  for (const auto& [entryDirs, file, categoryName] :
+       {std::tuple{QStringList{entryDir1.path(), entryDir2.path()}, systemFile,
+                   QString("System")},
+        std::tuple{QStringList{entryDir2.path(), entryDir1.path()}, utilityFile,
+                   QString("Utility")}}) {
+    ApplicationMenuConfig config(entryDirs, /*cacheFile=*/"");
+    QCOMPARE(config.entries_.size(), 1);
+    QCOMPARE(config.entries_.at("org.kde.dolphin")->appId, "org.kde.dolphin");
+    QCOMPARE(config.entries_.at("org.kde.dolphin")->desktopFile, file);
+    for (const auto& category : config.categories_) {
+      QCOMPARE(static_cast<int>(category.entries.size()),
+               (category.name == categoryName) ? 1 : 0);
+    }
+  }
+}
+
+void ApplicationMenuConfigTest::reload_delta() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+  writeEntry(entryDir.path() + "/chrome.desktop",
+             {"chrome", "Chrome", "Web Browser", "chrome", "chrome", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/mail.desktop",
+             {"mail", "Mail", "Email Client", "mail", "mail", ""},
+             "Network;Office");
+
+  ApplicationMenuConfig config({ entryDir.path() }, /*cacheFile=*/"");
+  std::vector<ApplicationMenuDelta> deltas;
+  connect(&config, &ApplicationMenuConfig::entriesChanged,
+          [&deltas](const ApplicationMenuDelta& delta) { deltas.push_back(delta); });
+
+  // Nothing has changed.
+  config.reload();
+  QCOMPARE(static_cast<int>(deltas.size()), 0);
+
+  writeEntry(entryDir.path() + "/chrome.desktop",
+             {"chrome", "Google Chrome", "Web Browser", "chrome", "chrome", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/gimp.desktop",
+             {"gimp", "GIMP", "Image Editor", "gimp", "gimp", ""},
+             "Graphics");
+  config.reload();
+  QCOMPARE(static_cast<int>(deltas.size()), 1);
+  const auto& delta = deltas[0];
+  QCOMPARE(static_cast<int>(delta.categories.size()), 2);
+  for (const auto& categoryDelta : delta.categories) {
+    if (categoryDelta.category == "Network") {
+      QCOMPARE(static_cast<int>(categoryDelta.removed.size()), 1);
+      QCOMPARE(categoryDelta.removed[0].name, "Chrome");
+      QCOMPARE(static_cast<int>(categoryDelta.added.size()), 1);
+      QCOMPARE(categoryDelta.added[0].name, "Google Chrome");
+    } else {
+      QCOMPARE(categoryDelta.category, "Graphics");
+      QCOMPARE(static_cast<int>(categoryDelta.removed.size()), 0);
+      QCOMPARE(static_cast<int>(categoryDelta.added.size()), 1);
+    }
+  }
+}
+
 void ApplicationMenuConfigTest::tryMatchingApplicationId() {
   QTemporaryDir entryDir;
   QVERIFY(entryDir.isValid());
@@ -234,6 +367,48 @@ void ApplicationMenuConfigTest::tryMatchingApplicationId() {
            "sonic unleashed shortcut");
 }
 
+void ApplicationMenuConfigTest::searchApplications() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+  writeEntry(entryDir.path() + "/firefox.desktop",
+             {"firefox", "Firefox", "Web Browser", "firefox", "firefox", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/chromium.desktop",
+             {"chromium", "Chromium", "Web Browser", "chromium", "chromium", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/org.kde.dolphin.desktop",
+             {"org.kde.dolphin", "Dolphin", "File Manager", "system-file-manager", "dolphin",
+              ""},
+             "System",
+             {{"Keywords", "files;folder;explorer;"}});
+  writeEntry(entryDir.path() + "/firewall.desktop",
+             {"firewall", "Firewall Settings", "Firewall", "firewall", "firewall-config", ""},
+             "System",
+             {{"NoDisplay", "true"}});
+
+  ApplicationMenuConfig config({ entryDir.path() }, /*cacheFile=*/"");
+
+  auto names = [&config](const QString& text, unsigned int maxNumResults = 10) {
+    QStringList names;
+    for (const auto& entry : config.searchApplications(text, maxNumResults)) {
+      names.append(entry.name);
+    }
+    return names;
+  };
+
+  QCOMPARE(names("f"), QStringList({"Firefox"}));
+  // Incremental search, hidden entries are not matched.
+  QCOMPARE(names("fi"), QStringList({"Firefox", "Dolphin"}));
+  QCOMPARE(names("fir"), QStringList({"Firefox"}));
+  // Equal scores are ranked by name length.
+  QCOMPARE(names("web"), QStringList({"Firefox", "Chromium"}));
+  QCOMPARE(names("web", 1), QStringList({"Firefox"}));
+  QCOMPARE(names("explorer"), QStringList({"Dolphin"}));
+  // Fuzzy match.
+  QCOMPARE(names("frfx"), QStringList({"Firefox"}));
+  QCOMPARE(names("xyz"), QStringList());
+}
+
 }  // namespace crystaldock
 
 QTEST_GUILESS_MAIN(crystaldock::ApplicationMenuConfigTest)
@@ -19,9 +19,10 @@
 #ifndef CRYSTALDOCK_APPLICATION_MENU_ENTRY_H_
 #define CRYSTALDOCK_APPLICATION_MENU_ENTRY_H_
 
-#include <list>
+#include <vector>
 
 #include <QString>
+#include <QStringList>
 
 namespace crystaldock {
 
@@ -59,6 +60,25 @@ inline bool operator<(const ApplicationEntry &e1, const ApplicationEntry &e2) {
   return e1.name.toLower() < e2.name.toLower();
 }
 
+// The fields of a desktop file that we need for an application entry.
+struct ParsedDesktopEntry {
+  QString appId;
+  // Localized, for display and search.
+  QString name;
+  // Not localized, for matching windows to entries regardless of the locale.
+  QString unlocalizedName;
+  QString genericName;
+  QString icon;
+  // Exec with field codes filtered out.
+  QString command;
+  QString wmClass;
+  QStringList categories;
+  QStringList keywords;
+  // The path to the desktop file.
+  QString file;
+  bool hidden = false;
+};
+
 // A category in the application menu.
 struct Category {
   // Name for the category e.g. 'Development' or 'Utility'. See:
@@ -71,19 +91,34 @@ struct Category {
   // Icon name for the category e.g. 'applications-internet'.
   QString icon;
 
-  // Application entries for this category.
-  std::list<ApplicationEntry> entries;
+  // Application entries for this category, sorted by name.
+  std::vector<ApplicationEntry> entries;
 
   Category(const QString& name2, const QString& displayName2,
            const QString& icon2)
       : name(name2), displayName(displayName2), icon(icon2) {}
 
   Category(const QString& name2, const QString& displayName2,
-           const QString& icon2, std::list<ApplicationEntry> entries2)
+           const QString& icon2, std::vector<ApplicationEntry> entries2)
       : name(name2), displayName(displayName2), icon(icon2), entries(entries2) {
   }
 };
 
+// The changes to the application entries after a reload.
+struct ApplicationMenuDelta {
+  struct CategoryDelta {
+    QString category;
+    // A changed entry is removed in its old form and added in its new form.
+    std::vector<ApplicationEntry> removed;
+    std::vector<ApplicationEntry> added;
+  };
+
+  // Only the categories that have changed.
+  std::vector<CategoryDelta> categories;
+
+  bool empty() const { return categories.empty(); }
+};
+
 }  // namespace crystaldock
 
 #endif  // CRYSTALDOCK_APPLICATION_MENU_ENTRY_H_
@@ -0,0 +1,234 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "application_search_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <utils/command_utils.h>
+
+namespace crystaldock {
+
+namespace {
+
+// Scores of the different kinds of matches, best first.
+constexpr int kNameExact = 1000;
+constexpr int kNamePrefix = 900;
+constexpr int kNameWordPrefix = 800;
+constexpr int kNameContains = 600;
+constexpr int kGenericNameWordPrefix = 500;
+constexpr int kKeywordPrefix = 450;
+constexpr int kGenericNameContains = 400;
+constexpr int kCommandPrefix = 350;
+constexpr int kKeywordContains = 300;
+constexpr int kCommandContains = 250;
+constexpr int kNameFuzzy = 100;
+constexpr int kCommandFuzzy = 50;
+
+bool isWordStart(const QString& text, qsizetype pos) {
+  return pos == 0 || !text[pos - 1].isLetterOrNumber();
+}
+
+// Whether a word in the text starts with the query.
+bool hasWordPrefix(const QString& text, const QString& query) {
+  for (qsizetype pos = text.indexOf(query); pos >= 0; pos = text.indexOf(query, pos + 1)) {
+    if (isWordStart(text, pos)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the score of the query as a subsequence of the text, in [1, maxScore],
+// or 0 if it is not one. Consecutive characters and characters at the start of
+// words score higher, e.g. "frfx" for "firefox" or "lo" for "libreoffice".
+int subsequenceScore(const QString& text, const QString& query, int maxScore) {
+  int score = 1;
+  qsizetype last = -2;
+  for (const QChar c : query) {
+    const qsizetype pos = text.indexOf(c, last + 1);
+    if (pos < 0) {
+      return 0;
+    }
+    if (pos == last + 1) {
+      score += 3;
+    }
+    if (isWordStart(text, pos)) {
+      score += 2;
+    }
+    last = pos;
+  }
+  return std::min(score, maxScore);
+}
+
+}  // namespace
+
+void ApplicationSearchIndex::add(const ApplicationEntry& entry, const QStringList& keywords) {
+  Document document{entry,
+                    entry.name.toLower(),
+                    entry.genericName.toLower(),
+                    {},
+                    getShortCommand(entry.command).toLower(),
+                    0};
+  for (const auto& keyword : keywords) {
+    document.keywords.append(keyword.toLower());
+  }
+  document.signature = signature(document.name) | signature(document.genericName) |
+                       signature(document.keywords.join(' ')) | signature(document.command);
+  documents_.push_back(std::move(document));
+}
+
+/* static */ uint64_t ApplicationSearchIndex::signatureBit(QChar c) {
+  const char16_t u = c.unicode();
+  if (u >= 'a' && u <= 'z') {
+    return uint64_t{1} << (u - 'a');
+  }
+  if (u >= '0' && u <= '9') {
+    return uint64_t{1} << (26 + u - '0');
+  }
+  return uint64_t{1} << (36 + u % 28);
+}
+
+/* static */ uint64_t ApplicationSearchIndex::signature(const QString& text) {
+  uint64_t result = 0;
+  for (const QChar c : text) {
+    result |= signatureBit(c);
+  }
+  return result;
+}
+
+/* static */ int ApplicationSearchIndex::score(const Document& document, const QString& query) {
+  const QString& name = document.name;
+  if (name == query) {
+    return kNameExact;
+  }
+  if (name.startsWith(query)) {
+    return kNamePrefix;
+  }
+  if (hasWordPrefix(name, query)) {
+    return kNameWordPrefix;
+  }
+  // A single character matches too many entries otherwise.
+  if (query.length() == 1) {
+    return 0;
+  }
+  if (name.contains(query)) {
+    return kNameContains;
+  }
+  if (hasWordPrefix(document.genericName, query)) {
+    return kGenericNameWordPrefix;
+  }
+
+  int best = 0;
+  for (const auto& keyword : document.keywords) {
+    if (keyword.startsWith(query)) {
+      return kKeywordPrefix;
+    }
+    if (keyword.contains(query)) {
+      best = kKeywordContains;
+    }
+  }
+  if (document.genericName.contains(query)) {
+    return kGenericNameContains;
+  }
+  if (document.command.startsWith(query)) {
+    return kCommandPrefix;
+  }
+  if (best > 0) {
+    return best;
+  }
+  if (document.command.contains(query)) {
+    return kCommandContains;
+  }
+
+  if (const int fuzzy = subsequenceScore(name, query, kNameFuzzy - 1)) {
+    return kNameFuzzy + fuzzy;
+  }
+  if (const int fuzzy = subsequenceScore(document.command, query, kCommandFuzzy - 1)) {
+    return kCommandFuzzy + fuzzy;
+  }
+  return 0;
+}
+
+std::vector<ApplicationEntry> ApplicationSearchIndex::search(
+    const QString& text, unsigned int maxNumResults, SearchState* state) const {
+  const QString query = text.trimmed().toLower();
+  if (query.isEmpty() || maxNumResults == 0) {
+    if (state) {
+      *state = {};
+    }
+    return {};
+  }
+
+  // Every kind of match only gets narrower as the query grows, except that a
+  // single character only matches the names.
+  const bool narrow = state && state->query.length() > 1 && query.startsWith(state->query);
+  const uint64_t querySignature = signature(query);
+  std::vector<std::pair<int, int>> matches;  // Score, document.
+  auto match = [&](int i) {
+    const auto& document = documents_[i];
+    if ((document.signature & querySignature) != querySignature) {
+      return;
+    }
+    if (const int documentScore = score(document, query)) {
+      matches.emplace_back(documentScore, i);
+    }
+  };
+  if (narrow) {
+    for (int i : state->matches) {
+      match(i);
+    }
+  } else {
+    for (int i = 0; i < size(); ++i) {
+      match(i);
+    }
+  }
+
+  if (state) {
+    state->query = query;
+    state->matches.clear();
+    for (const auto& [documentScore, i] : matches) {
+      state->matches.push_back(i);
+    }
+  }
+
+  // Best score first, then shorter names, then by name.
+  const auto numResults = std::min<size_t>(maxNumResults, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + numResults, matches.end(),
+                    [this](const std::pair<int, int>& m1, const std::pair<int, int>& m2) {
+    if (m1.first != m2.first) {
+      return m1.first > m2.first;
+    }
+    const auto& name1 = documents_[m1.second].name;
+    const auto& name2 = documents_[m2.second].name;
+    if (name1.length() != name2.length()) {
+      return name1.length() < name2.length();
+    }
+    return name1 < name2;
+  });
+
+  std::vector<ApplicationEntry> results;
+  results.reserve(numResults);
+  for (size_t i = 0; i < numResults; ++i) {
+    results.push_back(documents_[matches[i].second].entry);
+  }
+  return results;
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_APPLICATION_SEARCH_INDEX_H_
+#define CRYSTALDOCK_APPLICATION_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+#include "application_menu_entry.h"
+
+namespace crystaldock {
+
+// Search index of the application entries, built once per load.
+//
+// Every entry has its searchable fields (name, generic name, keywords and
+// command) pre-lowercased, plus a signature of the characters they contain,
+// so that most entries are rejected with a single bit test. Matches are
+// ranked by a fuzzy score and only the top ones are fully sorted.
+//
+// The index is immutable once built, so it can be searched from any thread.
+class ApplicationSearchIndex {
+ public:
+  // The state of a previous search. If the next query extends the previous
+  // one, only the entries that matched the previous one are searched.
+  struct SearchState {
+    QString query;
+    std::vector<int> matches;
+  };
+
+  // Adds a (non-hidden) entry to the index.
+  void add(const ApplicationEntry& entry, const QStringList& keywords);
+
+  int size() const { return static_cast<int>(documents_.size()); }
+
+  // Returns up to `maxNumResults` matching entries, best matches first.
+  // `state` is updated for the next search if not null.
+  std::vector<ApplicationEntry> search(const QString& text, unsigned int maxNumResults,
+                                       SearchState* state = nullptr) const;
+
+ private:
+  struct Document {
+    ApplicationEntry entry;
+    QString name;
+    QString genericName;
+    QStringList keywords;
+    QString command;
+    // Characters in all the fields above.
+    uint64_t signature;
+  };
+
+  // Returns the signature bit of a lower-case character.
+  static uint64_t signatureBit(QChar c);
+  static uint64_t signature(const QString& text);
+
+  // Returns the score of the document for the lower-case query, 0 if no match.
+  static int score(const Document& document, const QString& query);
+
+  std::vector<Document> documents_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_APPLICATION_SEARCH_INDEX_H_
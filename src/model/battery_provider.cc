@@ -0,0 +1,177 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "battery_provider.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDir>
+#include <QFile>
+
+namespace crystaldock {
+
+namespace {
+
+constexpr char kUPowerService[] = "org.freedesktop.UPower";
+constexpr char kUPowerDisplayDevice[] = "/org/freedesktop/UPower/devices/DisplayDevice";
+constexpr char kPropertiesInterface[] = "org.freedesktop.DBus.Properties";
+constexpr char kPropertiesChanged[] = "PropertiesChanged";
+
+// Reads a sysfs attribute, returns a null array if it does not exist.
+QByteArray readAttribute(const QString& dir, const char* name) {
+  QFile file(dir + "/" + name);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return {};
+  }
+  return file.readAll().trimmed();
+}
+
+bool isSystemBattery(const QString& dir) {
+  // Peripherals like wireless mice have "Device" scope.
+  return readAttribute(dir, "type") == "Battery" && readAttribute(dir, "scope") != "Device";
+}
+
+}  // namespace
+
+BatteryProvider::BatteryProvider(const QString& powerSupplyDir, bool useUPower)
+    : StatusProvider("Battery"), powerSupplyDir_(powerSupplyDir), useUPower_(useUPower) {
+  connect(&pollTimer_, &QTimer::timeout, this, &BatteryProvider::refresh);
+  uPowerWatcher_.setWatchMode(QDBusServiceWatcher::WatchForOwnerChange);
+  connect(&uPowerWatcher_, &QDBusServiceWatcher::serviceRegistered, this, [this] {
+    refresh();
+    setUPowerRunning(true);
+  });
+  connect(&uPowerWatcher_, &QDBusServiceWatcher::serviceUnregistered, this, [this] {
+    setUPowerRunning(false);
+  });
+}
+
+/* static */ QString BatteryProvider::findBattery(const QString& powerSupplyDir) {
+  const QDir dir(powerSupplyDir);
+  for (const auto& name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+    const QString path = dir.filePath(name);
+    if (isSystemBattery(path)) {
+      return path;
+    }
+  }
+  return "";
+}
+
+/* static */ BatteryInfo BatteryProvider::readBattery(const QString& batteryDir) {
+  BatteryInfo info;
+  if (!isSystemBattery(batteryDir)) {
+    return info;
+  }
+
+  info.present = true;
+  bool ok = false;
+  const int capacity = readAttribute(batteryDir, "capacity").toInt(&ok);
+  if (ok) {
+    info.level = capacity;
+  } else {
+    // Some batteries only report the charge in energy (uWh) or charge (uAh) units.
+    for (const auto& [now, full] : {std::pair{"energy_now", "energy_full"},
+                                    std::pair{"charge_now", "charge_full"}}) {
+      const double nowValue = readAttribute(batteryDir, now).toDouble();
+      const double fullValue = readAttribute(batteryDir, full).toDouble();
+      if (fullValue > 0) {
+        info.level = static_cast<int>(std::round(100 * nowValue / fullValue));
+        break;
+      }
+    }
+  }
+  info.level = std::clamp(info.level, 0, 100);
+  info.charging = readAttribute(batteryDir, "status") == "Charging";
+  return info;
+}
+
+void BatteryProvider::start() {
+  refresh();
+  uPowerConnected_ = useUPower_ && connectUPower();
+  pollTimer_.start(uPowerRunning_ ? kUPowerPollIntervalMs : kPollIntervalMs);
+}
+
+void BatteryProvider::stop() {
+  pollTimer_.stop();
+  if (uPowerConnected_) {
+    disconnectUPower();
+    uPowerConnected_ = false;
+  }
+}
+
+void BatteryProvider::refresh() {
+  fetchStarted();
+  BatteryInfo info;
+  if (!batteryDir_.isEmpty()) {
+    info = readBattery(batteryDir_);
+  }
+  if (!info.present) {
+    batteryDir_ = findBattery(powerSupplyDir_);
+    if (!batteryDir_.isEmpty()) {
+      info = readBattery(batteryDir_);
+    }
+  }
+  fetchFinished();
+
+  if (info == info_) {
+    return;
+  }
+
+  info_ = info;
+  emit batteryChanged(info_);
+}
+
+void BatteryProvider::onUPowerPropertiesChanged(
+    const QString& interface, const QVariantMap& changed, const QStringList& invalidated) {
+  refresh();
+}
+
+bool BatteryProvider::connectUPower() {
+  auto bus = QDBusConnection::systemBus();
+  if (!bus.connect(kUPowerService, kUPowerDisplayDevice, kPropertiesInterface,
+                   kPropertiesChanged, this,
+                   SLOT(onUPowerPropertiesChanged(QString, QVariantMap, QStringList)))) {
+    return false;
+  }
+
+  uPowerWatcher_.setConnection(bus);
+  uPowerWatcher_.addWatchedService(kUPowerService);
+  uPowerRunning_ = bus.interface() && bus.interface()->isServiceRegistered(kUPowerService).value();
+  return true;
+}
+
+void BatteryProvider::disconnectUPower() {
+  uPowerWatcher_.removeWatchedService(kUPowerService);
+  uPowerRunning_ = false;
+  QDBusConnection::systemBus().disconnect(
+      kUPowerService, kUPowerDisplayDevice, kPropertiesInterface, kPropertiesChanged,
+      this, SLOT(onUPowerPropertiesChanged(QString, QVariantMap, QStringList)));
+}
+
+void BatteryProvider::setUPowerRunning(bool running) {
+  uPowerRunning_ = running;
+  if (pollTimer_.isActive()) {
+    pollTimer_.start(uPowerRunning_ ? kUPowerPollIntervalMs : kPollIntervalMs);
+  }
+}
+
+}  // namespace crystaldock
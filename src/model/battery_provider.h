@@ -0,0 +1,108 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_BATTERY_PROVIDER_H_
+#define CRYSTALDOCK_BATTERY_PROVIDER_H_
+
+#include <QDBusServiceWatcher>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+#include "status_provider.h"
+
+namespace crystaldock {
+
+// State of the system battery.
+struct BatteryInfo {
+  bool present = false;
+  int level = 0;  // in percentage.
+  bool charging = false;
+
+  bool operator==(const BatteryInfo& other) const = default;
+};
+
+// Source of the battery state, shared by all docks.
+//
+// The state is read directly from the power supply class in sysfs, without
+// spawning any process. Sysfs does not notify changes, so the state is
+// re-read on UPower's PropertiesChanged signals while UPower is running on
+// the system bus, and on a faster timer otherwise. Subscribers are only notified when the
+// level or the charging state changes.
+class BatteryProvider : public StatusProvider {
+  Q_OBJECT
+
+ public:
+  static constexpr char kPowerSupplyDir[] = "/sys/class/power_supply";
+
+  // `powerSupplyDir` can be a fake sysfs dir for testing.
+  explicit BatteryProvider(const QString& powerSupplyDir = kPowerSupplyDir,
+                           bool useUPower = false);
+
+  // Returns the dir of the first system battery in the power supply dir,
+  // or an empty string if there is none.
+  static QString findBattery(const QString& powerSupplyDir = kPowerSupplyDir);
+
+  const BatteryInfo& info() const { return info_; }
+
+  // Re-reads the battery state from sysfs.
+  void refresh();
+
+ signals:
+  void batteryChanged(const BatteryInfo& info);
+
+ private slots:
+  void onUPowerPropertiesChanged(const QString& interface, const QVariantMap& changed,
+                                 const QStringList& invalidated);
+
+ protected:
+  // The monitoring only runs while there are subscribers.
+  void start() override;
+  void stop() override;
+
+ private:
+  static constexpr int kPollIntervalMs = 10000;
+  // With UPower, only in case a change does not come with a signal.
+  static constexpr int kUPowerPollIntervalMs = 60000;
+
+  // Reads the state of a battery dir.
+  static BatteryInfo readBattery(const QString& batteryDir);
+
+  bool connectUPower();
+  void disconnectUPower();
+
+  // Only slows down the polling while the UPower service is running, as
+  // connecting to its signals succeeds even if it is not.
+  void setUPowerRunning(bool running);
+
+  QString powerSupplyDir_;
+  bool useUPower_;
+  bool uPowerConnected_ = false;
+  bool uPowerRunning_ = false;
+  QDBusServiceWatcher uPowerWatcher_;
+
+  // Found on the first refresh, re-searched if it disappears.
+  QString batteryDir_;
+  BatteryInfo info_;
+  QTimer pollTimer_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_BATTERY_PROVIDER_H_
@@ -0,0 +1,133 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "battery_provider.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace crystaldock {
+
+class BatteryProviderTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void findBattery();
+  void refresh_capacity();
+  void refresh_energy();
+  void refresh_removed();
+
+ private:
+  // Writes a fake power supply attribute, creating its dir if needed.
+  void writeAttribute(const QTemporaryDir& dir, const QString& supply, const QString& name,
+                      const QByteArray& value) {
+    QVERIFY(QDir(dir.path()).mkpath(supply));
+    QFile file(dir.path() + "/" + supply + "/" + name);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(value + "\n");
+  }
+};
+
+void BatteryProviderTest::findBattery() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QVERIFY(BatteryProvider::findBattery(dir.path()).isEmpty());
+
+  writeAttribute(dir, "AC", "type", "Mains");
+  writeAttribute(dir, "hidpp_battery_0", "type", "Battery");
+  writeAttribute(dir, "hidpp_battery_0", "scope", "Device");
+  QVERIFY(BatteryProvider::findBattery(dir.path()).isEmpty());
+
+  writeAttribute(dir, "BAT1", "type", "Battery");
+  writeAttribute(dir, "BAT0", "type", "Battery");
+  QCOMPARE(BatteryProvider::findBattery(dir.path()), QString(dir.path() + "/BAT0"));
+}
+
+void BatteryProviderTest::refresh_capacity() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  writeAttribute(dir, "BAT0", "type", "Battery");
+  writeAttribute(dir, "BAT0", "capacity", "42");
+  writeAttribute(dir, "BAT0", "status", "Discharging");
+
+  BatteryProvider provider(dir.path());
+  QSignalSpy spy(&provider, &BatteryProvider::batteryChanged);
+  provider.refresh();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(provider.info(), (BatteryInfo{true, 42, false}));
+
+  // Unchanged.
+  provider.refresh();
+  QCOMPARE(spy.count(), 1);
+
+  writeAttribute(dir, "BAT0", "status", "Charging");
+  provider.refresh();
+  QCOMPARE(spy.count(), 2);
+  QCOMPARE(provider.info(), (BatteryInfo{true, 42, true}));
+
+  writeAttribute(dir, "BAT0", "capacity", "43");
+  provider.refresh();
+  QCOMPARE(spy.count(), 3);
+  QCOMPARE(provider.info(), (BatteryInfo{true, 43, true}));
+}
+
+void BatteryProviderTest::refresh_energy() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  writeAttribute(dir, "BAT0", "type", "Battery");
+  writeAttribute(dir, "BAT0", "energy_now", "30000000");
+  writeAttribute(dir, "BAT0", "energy_full", "40000000");
+  writeAttribute(dir, "BAT0", "status", "Full");
+
+  BatteryProvider provider(dir.path());
+  provider.refresh();
+  QCOMPARE(provider.info(), (BatteryInfo{true, 75, false}));
+}
+
+void BatteryProviderTest::refresh_removed() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  writeAttribute(dir, "BAT0", "type", "Battery");
+  writeAttribute(dir, "BAT0", "capacity", "80");
+
+  BatteryProvider provider(dir.path());
+  QSignalSpy spy(&provider, &BatteryProvider::batteryChanged);
+  provider.refresh();
+  QCOMPARE(provider.info(), (BatteryInfo{true, 80, false}));
+
+  QVERIFY(QDir(dir.path() + "/BAT0").removeRecursively());
+  provider.refresh();
+  QCOMPARE(spy.count(), 2);
+  QCOMPARE(provider.info(), BatteryInfo{});
+
+  // Swapped to another slot.
+  writeAttribute(dir, "BAT1", "type", "Battery");
+  writeAttribute(dir, "BAT1", "capacity", "60");
+  provider.refresh();
+  QCOMPARE(spy.count(), 3);
+  QCOMPARE(provider.info(), (BatteryInfo{true, 60, false}));
+}
+
+}  // namespace crystaldock
+
+QTEST_GUILESS_MAIN(crystaldock::BatteryProviderTest)
+#include "battery_provider_test.moc"
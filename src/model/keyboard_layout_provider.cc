@@ -0,0 +1,313 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_layout_provider.h"
+
+#include <iostream>
+#include <utility>
+
+#include <QDBusArgument>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QFile>
+#include <QLocale>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QSysInfo>
+
+#include <utils/command_runner.h>
+
+namespace crystaldock {
+
+namespace {
+
+constexpr char kPropertiesInterface[] = "org.freedesktop.DBus.Properties";
+
+// The language name as listed by "ibus list-engine", from the language code.
+QString getLanguageName(const QString& code) {
+  const QLocale::Language language = QLocale::codeToLanguage(code.section('_', 0, 0));
+  return language == QLocale::AnyLanguage ? "Other" : QLocale::languageToString(language);
+}
+
+}  // namespace
+
+KeyboardLayoutProvider::KeyboardLayoutProvider() : StatusProvider("Keyboard Layout") {}
+
+void KeyboardLayoutProvider::start() {
+  // The available engines do not change while IBus is running.
+  if (!layouts_) {
+    loadLayouts();
+  }
+}
+
+/* static */ QString KeyboardLayoutProvider::getIBusAddress() {
+  const QString address = qEnvironmentVariable("IBUS_ADDRESS");
+  if (!address.isEmpty()) {
+    return address;
+  }
+
+  // Same as ibus_get_socket_path().
+  QString socketFile = qEnvironmentVariable("IBUS_ADDRESS_FILE");
+  if (socketFile.isEmpty()) {
+    QString host = "unix";
+    QString displayNumber = "0";
+    if (qEnvironmentVariableIsSet("WAYLAND_DISPLAY")) {
+      displayNumber = qEnvironmentVariable("WAYLAND_DISPLAY");
+    } else if (qEnvironmentVariableIsSet("DISPLAY")) {
+      // E.g. "hostname:0.0".
+      const QString display = qEnvironmentVariable("DISPLAY");
+      if (!display.section(':', 0, 0).isEmpty()) {
+        host = display.section(':', 0, 0);
+      }
+      displayNumber = display.section(':', 1).section('.', 0, 0);
+    }
+    socketFile = QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+        + "/ibus/bus/" + QString::fromLatin1(QSysInfo::machineUniqueId())
+        + "-" + host + "-" + displayNumber;
+  }
+
+  QFile file(socketFile);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return {};
+  }
+  while (!file.atEnd()) {
+    const QString line = QString::fromUtf8(file.readLine()).trimmed();
+    if (line.startsWith("IBUS_ADDRESS=")) {
+      return line.section('=', 1);
+    }
+  }
+  return {};
+}
+
+/* static */ KeyboardLayoutInfo KeyboardLayoutProvider::parseEngineDesc(const QVariant& desc) {
+  if (desc.metaType() != QMetaType::fromType<QDBusArgument>()) {
+    return {};
+  }
+
+  // (s a{sv} s s s s ...): the type name, the attachments, then the name,
+  // long name, description and language of the engine, followed by fields
+  // that depend on the IBus version.
+  const QDBusArgument arg = desc.value<QDBusArgument>();
+  QString typeName;
+  QVariantMap attachments;
+  QString name;
+  QString longName;
+  QString description;
+  QString language;
+  arg.beginStructure();
+  arg >> typeName >> attachments >> name >> longName >> description >> language;
+  arg.endStructure();
+  if (typeName != "IBusEngineDesc") {
+    return {};
+  }
+  return KeyboardLayoutInfo(getLanguageName(language), name, longName);
+}
+
+bool KeyboardLayoutProvider::connectIBusBus() {
+  if (bus_.isConnected()) {
+    return true;
+  }
+
+  const QString address = getIBusAddress();
+  if (address.isEmpty()) {
+    return false;
+  }
+  bus_ = QDBusConnection::connectToBus(address, "ibus");
+  if (!bus_.isConnected()) {
+    std::cerr << "Failed to connect to the IBus bus: "
+              << bus_.lastError().message().toStdString() << std::endl;
+    QDBusConnection::disconnectFromBus("ibus");
+    bus_ = QDBusConnection(QString());
+    return false;
+  }
+
+  bus_.connect(kService, kPath, kInterface, "GlobalEngineChanged",
+               this, SLOT(onGlobalEngineChanged(QString)));
+  return true;
+}
+
+void KeyboardLayoutProvider::loadLayouts() {
+  if (loading_) {
+    return;
+  }
+
+  loading_ = true;
+  fetchStarted();
+  if (connectIBusBus()) {
+    loadLayoutsFromIBusBus();
+  } else {
+    loadLayoutsWithCommand();
+  }
+}
+
+void KeyboardLayoutProvider::loadLayoutsFromIBusBus() {
+  auto message = QDBusMessage::createMethodCall(kService, kPath, kPropertiesInterface, "Get");
+  message << QString(kInterface) << QString("Engines");
+  auto* watcher = new QDBusPendingCallWatcher(bus_.asyncCall(message), this);
+  connect(watcher, &QDBusPendingCallWatcher::finished, this,
+          [this](QDBusPendingCallWatcher* call) {
+    call->deleteLater();
+    QDBusPendingReply<QDBusVariant> reply = *call;
+    if (reply.isError()) {
+      std::cerr << "Failed to list the IBus engines: "
+                << reply.error().message().toStdString() << std::endl;
+      loading_ = false;
+      fetchFinished();
+      return;
+    }
+
+    auto layouts = std::make_shared<KeyboardLayouts>();
+    const QDBusArgument engines = reply.value().variant().value<QDBusArgument>();
+    engines.beginArray();
+    while (!engines.atEnd()) {
+      QDBusVariant engine;
+      engines >> engine;
+      KeyboardLayoutInfo layout = parseEngineDesc(engine.variant());
+      if (!layout.isEmpty()) {
+        layouts->layouts[layout.language].push_back(layout);
+        layouts->engines[layout.engine] = layout;
+      }
+    }
+    engines.endArray();
+
+    // Gets the currently active keyboard layout.
+    auto message = QDBusMessage::createMethodCall(kService, kPath, kInterface,
+                                                  "GetGlobalEngine");
+    auto* watcher = new QDBusPendingCallWatcher(bus_.asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, layouts](QDBusPendingCallWatcher* call) {
+      call->deleteLater();
+      QDBusPendingReply<QDBusVariant> reply = *call;
+      if (!reply.isError()) {
+        activeEngine_ = parseEngineDesc(reply.value().variant()).engine;
+      }
+      finishLoading(layouts);
+    });
+  });
+}
+
+void KeyboardLayoutProvider::loadLayoutsWithCommand() {
+  CommandOptions options;
+  options.coalesce = true;
+  CommandRunner::self()->run(kCommand, {"list-engine"}, this,
+                             [this, options](const CommandResult& result) {
+    if (!result.ok()) {
+      loading_ = false;
+      fetchFinished();
+      return;
+    }
+
+    auto layouts = std::make_shared<KeyboardLayouts>();
+    static const QRegularExpression kLanguageRe(R"(language:\s+(.+))");
+    static const QRegularExpression kKeyboardRe(R"(\s*(.+)\s+-\s+(.+))");
+    QString language;
+    for (const QByteArray& line : result.output.split('\n')) {
+      QRegularExpressionMatch match = kLanguageRe.match(line);
+      if (match.hasMatch()) {
+        language = match.captured(1).trimmed();
+      } else {
+        match = kKeyboardRe.match(line);
+        if (match.hasMatch() && !language.isEmpty()) {
+          QString engine = match.captured(1).trimmed();
+          QString description = match.captured(2).trimmed();
+          auto& languageLayouts = layouts->layouts[language];
+          languageLayouts.push_back(KeyboardLayoutInfo(language, engine, description));
+          layouts->engines[engine] = languageLayouts.back();
+        }
+      }
+    }
+
+    // Gets the currently active keyboard layout.
+    CommandRunner::self()->run(kCommand, {"engine"}, this,
+                               [this, layouts](const CommandResult& result) {
+      if (result.ok()) {
+        activeEngine_ = result.output.trimmed();
+      }
+      finishLoading(layouts);
+    }, options);
+  }, options);
+}
+
+void KeyboardLayoutProvider::finishLoading(std::shared_ptr<const KeyboardLayouts> layouts) {
+  loading_ = false;
+  fetchFinished();
+
+  layouts_ = std::move(layouts);
+  emit layoutsLoaded(layouts_);
+  if (!pendingEngine_.isEmpty()) {
+    const QString engine = std::exchange(pendingEngine_, {});
+    setActiveEngine(engine);
+  }
+}
+
+void KeyboardLayoutProvider::setActiveEngine(const QString& engine) {
+  if (engine.isEmpty() || engine == (pendingEngine_.isEmpty() ? activeEngine_ : pendingEngine_)) {
+    return;
+  }
+
+  pendingEngine_ = engine;
+  // Applied when the running command finishes.
+  if (loading_ || settingEngine_) {
+    return;
+  }
+
+  settingEngine_ = true;
+  if (bus_.isConnected()) {
+    auto message = QDBusMessage::createMethodCall(kService, kPath, kInterface,
+                                                  "SetGlobalEngine");
+    message << engine;
+    auto* watcher = new QDBusPendingCallWatcher(bus_.asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, engine](QDBusPendingCallWatcher* call) {
+      call->deleteLater();
+      finishSettingEngine(engine);
+    });
+    return;
+  }
+
+  CommandRunner::self()->run(kCommand, {"engine", engine}, this,
+                             [this, engine](const CommandResult& result) {
+    // Somehow IBus returns 1 here even when it succeeded.
+    finishSettingEngine(engine);
+  });
+}
+
+void KeyboardLayoutProvider::finishSettingEngine(const QString& engine) {
+  settingEngine_ = false;
+  activeEngine_ = engine;
+  emit activeEngineChanged(activeEngine_);
+
+  const QString nextEngine = std::exchange(pendingEngine_, {});
+  if (nextEngine != engine) {
+    setActiveEngine(nextEngine);
+  }
+}
+
+void KeyboardLayoutProvider::onGlobalEngineChanged(const QString& engine) {
+  // Our own changes are reported when the call finishes.
+  if (loading_ || settingEngine_ || engine.isEmpty() || engine == activeEngine_) {
+    return;
+  }
+  activeEngine_ = engine;
+  emit activeEngineChanged(activeEngine_);
+}
+
+}  // namespace crystaldock
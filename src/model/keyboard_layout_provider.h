@@ -0,0 +1,130 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_KEYBOARD_LAYOUT_PROVIDER_H_
+#define CRYSTALDOCK_KEYBOARD_LAYOUT_PROVIDER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QDBusConnection>
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+#include "status_provider.h"
+
+namespace crystaldock {
+
+struct KeyboardLayoutInfo {
+  QString language;
+  QString languageCode;
+  QString engine;
+  QString description;
+
+  KeyboardLayoutInfo() = default;
+
+  KeyboardLayoutInfo(const QString& language2, const QString& engine2, const QString& description2)
+      : language(language2), engine(engine2), description(description2) {
+    if (language.size() >= 2) {
+      languageCode = language.first(2).toUpper();
+    }
+  }
+
+  bool isEmpty() const { return engine.isEmpty(); }
+
+  QString toString() const { return language + " - " + description; }
+};
+
+// All the available keyboard layouts.
+struct KeyboardLayouts {
+  // As map from languages to list of structs.
+  std::map<QString, std::vector<KeyboardLayoutInfo>> layouts;
+  // As map from engines to structs.
+  std::map<QString, KeyboardLayoutInfo> engines;
+};
+
+// Source of the keyboard layouts and the active one, shared by all docks.
+// Integrates with IBus over its own D-Bus bus, or with the ibus command if the
+// bus cannot be found.
+class KeyboardLayoutProvider : public StatusProvider {
+  Q_OBJECT
+
+ public:
+  KeyboardLayoutProvider();
+
+  // Whether connected to the IBus bus.
+  bool usesIBusBus() const { return bus_.isConnected(); }
+
+  // Null until IBus has listed its engines.
+  std::shared_ptr<const KeyboardLayouts> layouts() const { return layouts_; }
+
+  // The engine that IBus currently uses.
+  const QString& activeEngine() const { return activeEngine_; }
+
+  void setActiveEngine(const QString& engine);
+
+ signals:
+  void layoutsLoaded(const std::shared_ptr<const KeyboardLayouts>& layouts);
+  void activeEngineChanged(const QString& engine);
+
+ protected:
+  // Lists the engines on the first subscription.
+  void start() override;
+  void stop() override {}
+
+ private slots:
+  // From IBus, including for changes by other applications.
+  void onGlobalEngineChanged(const QString& engine);
+
+ private:
+  static constexpr char kCommand[] = "ibus";
+  static constexpr char kService[] = "org.freedesktop.IBus";
+  static constexpr char kPath[] = "/org/freedesktop/IBus";
+  static constexpr char kInterface[] = "org.freedesktop.IBus";
+
+  // The address of the IBus bus, from the environment or IBus's socket file.
+  static QString getIBusAddress();
+  // Parses an engine from its serialized IBusEngineDesc.
+  static KeyboardLayoutInfo parseEngineDesc(const QVariant& desc);
+
+  bool connectIBusBus();
+  void loadLayouts();
+  void loadLayoutsFromIBusBus();
+  void loadLayoutsWithCommand();
+  // Sets the loaded layouts and applies any pending engine.
+  void finishLoading(std::shared_ptr<const KeyboardLayouts> layouts);
+  void finishSettingEngine(const QString& engine);
+
+  QDBusConnection bus_ = QDBusConnection(QString());
+
+  std::shared_ptr<const KeyboardLayouts> layouts_;
+  QString activeEngine_;
+  // The engine being set, if any.
+  QString pendingEngine_;
+
+  bool loading_ = false;
+  bool settingEngine_ = false;
+};
+
+}  // namespace crystaldock
+
+Q_DECLARE_METATYPE(crystaldock::KeyboardLayoutInfo);
+
+#endif  // CRYSTALDOCK_KEYBOARD_LAYOUT_PROVIDER_H_
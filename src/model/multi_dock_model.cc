@@ -24,6 +24,7 @@
 #include <QProcess>
 
 #include "display/window_system.h"
+#include "utils/icon_utils.h"
 
 namespace crystaldock {
 
@@ -32,9 +33,18 @@ MultiDockModel::MultiDockModel(const QString& configDir)
       appearanceConfig_(configHelper_.appearanceConfigPath(),
                         QSettings::IniFormat),
       desktopEnv_(DesktopEnv::getDesktopEnv()) {
+  // Ready by the time the user adds a dock.
+  DesktopEnv::queryDefaultWebBrowser();
   loadDocks();
-  connect(&applicationMenuConfig_, SIGNAL(configChanged()),
-          this, SIGNAL(applicationMenuConfigChanged()));
+  connect(&applicationMenuConfig_, &ApplicationMenuConfig::configChanged,
+          this, [this] {
+            // The entries have been reloaded.
+            resolvedApplications_.clear();
+            clearIconCache();
+            emit applicationMenuConfigChanged();
+          });
+  connect(&applicationMenuConfig_, &ApplicationMenuConfig::entriesChanged,
+          this, &MultiDockModel::applicationMenuEntriesChanged);
   if (maxIconSize() < minIconSize()) {
     setMaxIconSize(minIconSize());
   }
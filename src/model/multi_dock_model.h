@@ -20,6 +20,7 @@
 #define CRYSTALDOCK_MULTI_DOCK_MODEL_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -711,17 +712,23 @@ class MultiDockModel : public QObject {
     return applicationMenuConfig_.systemCategories();
   }
 
+  // Memoized by the raw app ID, including misses, until the application
+  // menu config changes.
   const ApplicationEntry* findApplication(const std::string& appId) const {
-    return applicationMenuConfig_.tryMatchingApplicationId(appId);
+    auto it = resolvedApplications_.find(appId);
+    if (it == resolvedApplications_.end()) {
+      it = resolvedApplications_.emplace(
+          appId, applicationMenuConfig_.tryMatchingApplicationId(appId)).first;
+    }
+    return it->second;
   }
 
   bool isAppMenuEntry(const std::string& appId) const {
     return applicationMenuConfig_.isAppMenuEntry(appId);
   }
 
-  const std::vector<ApplicationEntry> searchApplications(
-      const QString& text, unsigned int maxNumResults) const {
-    return applicationMenuConfig_.searchApplications(text, maxNumResults);
+  std::shared_ptr<const ApplicationSearchIndex> applicationSearchIndex() const {
+    return applicationMenuConfig_.searchIndex();
   }
 
  signals:
@@ -735,6 +742,7 @@ class MultiDockModel : public QObject {
   // Will require calling Plasma D-Bus to update the wallpaper.
   void wallpaperChanged(int screen);
   void applicationMenuConfigChanged();
+  void applicationMenuEntriesChanged(const ApplicationMenuDelta& delta);
 
  private:
   // Dock config's categories/properties.
@@ -896,6 +904,8 @@ class MultiDockModel : public QObject {
   int nextDockId_;
 
   ApplicationMenuConfig applicationMenuConfig_;
+  // Cache of findApplication(), with nullptr for unknown app IDs.
+  mutable std::unordered_map<std::string, const ApplicationEntry*> resolvedApplications_;
   DesktopEnv* desktopEnv_;
 };
 
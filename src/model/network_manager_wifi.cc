@@ -0,0 +1,379 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network_manager_wifi.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QMap>
+#include <QRegularExpression>
+
+#include "wifi_provider.h"
+
+// Connection settings, as setting names to their properties.
+using NMConnectionSettings = QMap<QString, QVariantMap>;
+Q_DECLARE_METATYPE(NMConnectionSettings)
+
+namespace crystaldock {
+
+namespace {
+
+constexpr char kPath[] = "/org/freedesktop/NetworkManager";
+constexpr char kInterface[] = "org.freedesktop.NetworkManager";
+constexpr char kDeviceInterface[] = "org.freedesktop.NetworkManager.Device";
+constexpr char kWirelessInterface[] = "org.freedesktop.NetworkManager.Device.Wireless";
+constexpr char kAccessPointInterface[] = "org.freedesktop.NetworkManager.AccessPoint";
+constexpr char kActiveConnectionInterface[] = "org.freedesktop.NetworkManager.Connection.Active";
+constexpr char kSettingsConnectionInterface[] =
+    "org.freedesktop.NetworkManager.Settings.Connection";
+constexpr char kPropertiesInterface[] = "org.freedesktop.DBus.Properties";
+
+constexpr unsigned int kDeviceTypeWifi = 2;
+
+// NM80211ApFlags and NM80211ApSecurityFlags.
+constexpr unsigned int kApFlagsPrivacy = 0x1;
+constexpr unsigned int kApSecurityKeyMgmtPsk = 0x100;
+constexpr unsigned int kApSecurityKeyMgmtSae = 0x400;
+
+QVariant unwrapVariant(const QVariant& value) {
+  return value.metaType() == QMetaType::fromType<QDBusVariant>()
+      ? qvariant_cast<QDBusVariant>(value).variant()
+      : value;
+}
+
+}  // namespace
+
+NetworkManagerWifi::NetworkManagerWifi(const QDBusConnection& bus, const QString& service)
+    : bus_(bus), service_(service) {
+  qDBusRegisterMetaType<NMConnectionSettings>();
+  scanTimer_.setSingleShot(true);
+  connect(&scanTimer_, &QTimer::timeout, this, [this] { finishScan(-1, false); });
+}
+
+void NetworkManagerWifi::init() {
+  if (initializing_ || isAvailable()) {
+    return;
+  }
+
+  initializing_ = true;
+  call(kPath, kInterface, "GetDevices", {}, [this](const QDBusPendingCall& call) {
+    QDBusPendingReply<QList<QDBusObjectPath>> reply = call;
+    if (reply.isError()) {
+      finishInit(false);  // No NetworkManager.
+      return;
+    }
+    findWifiDevice(reply.value(), 0);
+  });
+}
+
+void NetworkManagerWifi::findWifiDevice(const QList<QDBusObjectPath>& devices, int index) {
+  if (index >= devices.size()) {
+    finishInit(false);
+    return;
+  }
+
+  const QString device = devices[index].path();
+  getProperty(device, kDeviceInterface, "DeviceType",
+              [this, devices, index, device](const QVariant& value) {
+    if (value.toUInt() == kDeviceTypeWifi) {
+      device_ = device;
+      loadAccessPoints();
+    } else {
+      findWifiDevice(devices, index + 1);
+    }
+  });
+}
+
+void NetworkManagerWifi::loadAccessPoints() {
+  bus_.connect(service_, device_, kWirelessInterface, "AccessPointAdded",
+               this, SLOT(onAccessPointAdded(QDBusObjectPath)));
+  bus_.connect(service_, device_, kWirelessInterface, "AccessPointRemoved",
+               this, SLOT(onAccessPointRemoved(QDBusObjectPath)));
+  // For all the objects of the service: the device and its access points.
+  bus_.connect(service_, QString(), kPropertiesInterface, "PropertiesChanged",
+               this, SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+
+  getProperty(device_, kWirelessInterface, "ActiveAccessPoint", [this](const QVariant& value) {
+    activeAccessPoint_ = value.value<QDBusObjectPath>().path();
+    call(device_, kWirelessInterface, "GetAllAccessPoints", {},
+         [this](const QDBusPendingCall& call) {
+      QDBusPendingReply<QList<QDBusObjectPath>> reply = call;
+      const auto paths = reply.isError() ? QList<QDBusObjectPath>{} : reply.value();
+      if (paths.isEmpty()) {
+        finishInit(true);
+        return;
+      }
+
+      auto numPending = std::make_shared<int>(paths.size());
+      for (const auto& path : paths) {
+        loadAccessPoint(path.path(), [this, numPending]() {
+          if (--*numPending == 0) {
+            finishInit(true);
+          }
+        });
+      }
+    });
+  });
+}
+
+void NetworkManagerWifi::loadAccessPoint(const QString& path, std::function<void()> onLoaded) {
+  call(path, kPropertiesInterface, "GetAll", {QString(kAccessPointInterface)},
+       [this, path, onLoaded](const QDBusPendingCall& call) {
+    QDBusPendingReply<QVariantMap> reply = call;
+    if (!reply.isError()) {
+      const QVariantMap properties = reply.value();
+      accessPoints_[path] = {QString::fromUtf8(properties.value("Ssid").toByteArray()),
+                             properties.value("Strength").toUInt(),
+                             properties.value("Flags").toUInt(),
+                             properties.value("WpaFlags").toUInt(),
+                             properties.value("RsnFlags").toUInt()};
+    }
+    if (onLoaded) {
+      onLoaded();
+    } else if (!initializing_) {
+      emit networksChanged();
+    }
+  });
+}
+
+void NetworkManagerWifi::finishInit(bool available) {
+  initializing_ = false;
+  emit initialized(available);
+  if (available) {
+    emit networksChanged();
+  }
+}
+
+WifiStatus NetworkManagerWifi::status() const {
+  // Access points of the same network are merged.
+  std::map<QString, WifiNetwork> networks;
+  for (const auto& [path, accessPoint] : accessPoints_) {
+    if (accessPoint.ssid.isEmpty()) {
+      continue;  // Hidden network.
+    }
+    auto& network = networks[accessPoint.ssid];
+    network.name = accessPoint.ssid;
+    network.signal = std::max(network.signal, accessPoint.strength);
+    network.inUse = network.inUse || path == activeAccessPoint_;
+  }
+
+  WifiStatus status;
+  status.scanned = true;
+  for (auto& [ssid, network] : networks) {
+    if (network.signal > 0) {
+      status.networks.push_back(std::move(network));
+    }
+  }
+  // Strongest first, like nmcli.
+  std::stable_sort(status.networks.begin(), status.networks.end(),
+                   [](const WifiNetwork& n1, const WifiNetwork& n2) {
+    return n1.signal > n2.signal;
+  });
+  return status;
+}
+
+void NetworkManagerWifi::requestScan(std::function<void(bool)> onFinished) {
+  // Pending before the call, in case LastScan changes before the reply arrives.
+  const int id = nextScanId_++;
+  pendingScans_[id] = std::move(onFinished);
+  scanTimer_.start(kScanTimeoutMs);
+  call(device_, kWirelessInterface, "RequestScan", {QVariantMap()},
+       [this, id](const QDBusPendingCall& call) {
+    if (call.isError()) {
+      finishScan(id, false);
+    }
+  });
+}
+
+void NetworkManagerWifi::finishScan(int id, bool ok) {
+  std::vector<std::function<void(bool)>> callbacks;
+  for (auto it = pendingScans_.begin(); it != pendingScans_.end();) {
+    if (id < 0 || it->first == id) {
+      callbacks.push_back(std::move(it->second));
+      it = pendingScans_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (pendingScans_.empty()) {
+    scanTimer_.stop();
+  }
+  for (const auto& callback : callbacks) {
+    callback(ok);
+  }
+}
+
+void NetworkManagerWifi::connectWifi(const QString& network, const QString& password,
+                                     std::function<void(bool)> onFinished) {
+  const std::pair<const QString, AccessPoint>* accessPoint = nullptr;
+  for (const auto& element : accessPoints_) {
+    if (element.second.ssid == network &&
+        (!accessPoint || element.second.strength > accessPoint->second.strength)) {
+      accessPoint = &element;
+    }
+  }
+  if (!accessPoint) {
+    onFinished(false);
+    return;
+  }
+
+  // The other settings are filled in by NetworkManager from the access point.
+  NMConnectionSettings settings;
+  if (!password.isEmpty()) {
+    const auto security = securitySettings(accessPoint->second, password);
+    if (!security.isEmpty()) {
+      settings["802-11-wireless-security"] = security;
+    }
+  }
+  call(kPath, kInterface, "AddAndActivateConnection",
+       {QVariant::fromValue(settings), QVariant::fromValue(QDBusObjectPath(device_)),
+        QVariant::fromValue(QDBusObjectPath(accessPoint->first))},
+       [onFinished](const QDBusPendingCall& call) {
+    onFinished(!call.isError());
+  });
+}
+
+/* static */ QVariantMap NetworkManagerWifi::securitySettings(const AccessPoint& accessPoint,
+                                                             const QString& password) {
+  const unsigned int security = accessPoint.wpaFlags | accessPoint.rsnFlags;
+  if (security & kApSecurityKeyMgmtPsk) {
+    // Also for WPA3 transition mode networks.
+    return {{"key-mgmt", "wpa-psk"}, {"psk", password}};
+  }
+  if (security & kApSecurityKeyMgmtSae) {
+    return {{"key-mgmt", "sae"}, {"psk", password}};
+  }
+  if (security == 0 && (accessPoint.flags & kApFlagsPrivacy)) {
+    // WEP: a key of 5 or 13 characters, or 10 or 26 hex digits, otherwise a passphrase.
+    static const QRegularExpression kHexKey("^([0-9A-Fa-f]{10}|[0-9A-Fa-f]{26})$");
+    const bool isKey = password.size() == 5 || password.size() == 13 ||
+                       kHexKey.match(password).hasMatch();
+    return {{"key-mgmt", "none"}, {"wep-key0", password}, {"wep-key-type", isKey ? 1u : 2u}};
+  }
+  // Not a network with a password (e.g. open or 802.1X), a setting without
+  // key-mgmt would be invalid.
+  return {};
+}
+
+void NetworkManagerWifi::disconnectWifi(const QString& network,
+                                        std::function<void(bool)> onFinished) {
+  const auto active = accessPoints_.find(activeAccessPoint_);
+  if (active == accessPoints_.end() || active->second.ssid != network) {
+    onFinished(false);
+    return;
+  }
+
+  // Like "nmcli connection delete", so that the password is asked again next time.
+  getProperty(device_, kDeviceInterface, "ActiveConnection",
+              [this, onFinished](const QVariant& value) {
+    const QString activeConnection = value.value<QDBusObjectPath>().path();
+    if (activeConnection.isEmpty() || activeConnection == "/") {
+      onFinished(false);
+      return;
+    }
+    getProperty(activeConnection, kActiveConnectionInterface, "Connection",
+                [this, onFinished](const QVariant& value) {
+      const QString connection = value.value<QDBusObjectPath>().path();
+      if (connection.isEmpty() || connection == "/") {
+        onFinished(false);
+        return;
+      }
+      call(connection, kSettingsConnectionInterface, "Delete", {},
+           [onFinished](const QDBusPendingCall& call) {
+        onFinished(!call.isError());
+      });
+    });
+  });
+}
+
+void NetworkManagerWifi::onAccessPointAdded(const QDBusObjectPath& path) {
+  loadAccessPoint(path.path());
+}
+
+void NetworkManagerWifi::onAccessPointRemoved(const QDBusObjectPath& path) {
+  if (accessPoints_.erase(path.path()) > 0) {
+    emit networksChanged();
+  }
+}
+
+void NetworkManagerWifi::onPropertiesChanged(const QString& interface, const QVariantMap& changed,
+                                             const QStringList& invalidated) {
+  const QString path = message().path();
+  bool networksUpdated = false;
+  if (interface == kAccessPointInterface) {
+    auto it = accessPoints_.find(path);
+    if (it == accessPoints_.end()) {
+      return;
+    }
+    if (changed.contains("Strength")) {
+      it->second.strength = changed.value("Strength").toUInt();
+      networksUpdated = true;
+    }
+    if (changed.contains("Ssid")) {
+      it->second.ssid = QString::fromUtf8(changed.value("Ssid").toByteArray());
+      networksUpdated = true;
+    }
+  } else if (interface == kWirelessInterface && path == device_) {
+    if (changed.contains("ActiveAccessPoint")) {
+      activeAccessPoint_ = changed.value("ActiveAccessPoint").value<QDBusObjectPath>().path();
+      networksUpdated = true;
+    }
+    if (changed.contains("LastScan")) {
+      finishScan(-1, true);
+    }
+  }
+
+  if (networksUpdated && !initializing_) {
+    emit networksChanged();
+  }
+}
+
+void NetworkManagerWifi::call(const QString& path, const QString& interface,
+                              const QString& method, const QVariantList& args,
+                              std::function<void(const QDBusPendingCall&)> onReply) {
+  auto message = QDBusMessage::createMethodCall(service_, path, interface, method);
+  message.setArguments(args);
+  auto* watcher = new QDBusPendingCallWatcher(bus_.asyncCall(message), this);
+  connect(watcher, &QDBusPendingCallWatcher::finished, this,
+          [onReply](QDBusPendingCallWatcher* call) {
+    call->deleteLater();
+    onReply(*call);
+  });
+}
+
+void NetworkManagerWifi::getProperty(const QString& path, const QString& interface,
+                                     const QString& property,
+                                     std::function<void(const QVariant&)> onValue) {
+  call(path, kPropertiesInterface, "Get", {interface, property},
+       [onValue](const QDBusPendingCall& call) {
+    const QDBusMessage reply = call.reply();
+    onValue(reply.type() == QDBusMessage::ReplyMessage
+                ? unwrapVariant(reply.arguments().value(0)) : QVariant());
+  });
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,131 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_NETWORK_MANAGER_WIFI_H_
+#define CRYSTALDOCK_NETWORK_MANAGER_WIFI_H_
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+#include <QDBusConnection>
+#include <QDBusContext>
+#include <QDBusObjectPath>
+#include <QDBusPendingCall>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+namespace crystaldock {
+
+struct WifiStatus;
+
+// Wi-Fi networks from NetworkManager over D-Bus.
+//
+// The access points of the first Wi-Fi device are loaded once, then kept up
+// to date with the AccessPointAdded/Removed signals of the device and the
+// PropertiesChanged signals of the access points (e.g. signal strength) and
+// of the device (the active access point and the time of the last scan).
+class NetworkManagerWifi : public QObject, protected QDBusContext {
+  Q_OBJECT
+
+ public:
+  static constexpr char kService[] = "org.freedesktop.NetworkManager";
+
+  // The bus and service can be a mock service on the session bus for testing.
+  explicit NetworkManagerWifi(const QDBusConnection& bus = QDBusConnection::systemBus(),
+                              const QString& service = kService);
+
+  // Finds the Wi-Fi device and loads its access points. Emits initialized().
+  void init();
+
+  // Whether there is a Wi-Fi device, after init.
+  bool isAvailable() const { return !device_.isEmpty(); }
+
+  // The networks, one per SSID with the strongest access point's signal.
+  WifiStatus status() const;
+
+  // `onFinished` is called once the scan has completed, i.e. the device's
+  // LastScan has changed, or with false if the scan was rejected (e.g. too
+  // soon after the previous one) or has not completed in time.
+  void requestScan(std::function<void(bool)> onFinished);
+  // Activates a new connection to the network. A successful activation shows
+  // up as a change of the active access point.
+  void connectWifi(const QString& network, const QString& password,
+                   std::function<void(bool)> onFinished);
+  // Deletes the active connection, if it is to the network.
+  void disconnectWifi(const QString& network, std::function<void(bool)> onFinished);
+
+ signals:
+  void initialized(bool available);
+  void networksChanged();
+
+ private slots:
+  void onAccessPointAdded(const QDBusObjectPath& path);
+  void onAccessPointRemoved(const QDBusObjectPath& path);
+  void onPropertiesChanged(const QString& interface, const QVariantMap& changed,
+                           const QStringList& invalidated);
+
+ private:
+  static constexpr int kScanTimeoutMs = 30000;
+
+  struct AccessPoint {
+    QString ssid;
+    unsigned int strength = 0;
+    // NM80211ApFlags and the NM80211ApSecurityFlags of WPA and RSN (WPA2/WPA3).
+    unsigned int flags = 0;
+    unsigned int wpaFlags = 0;
+    unsigned int rsnFlags = 0;
+  };
+
+  // Calls the method and the callback with the reply, or an error reply.
+  void call(const QString& path, const QString& interface, const QString& method,
+            const QVariantList& args, std::function<void(const QDBusPendingCall&)> onReply);
+  void getProperty(const QString& path, const QString& interface, const QString& property,
+                   std::function<void(const QVariant&)> onValue);
+
+  // Checks the devices from `index` for the Wi-Fi one.
+  void findWifiDevice(const QList<QDBusObjectPath>& devices, int index);
+  void loadAccessPoints();
+  void loadAccessPoint(const QString& path, std::function<void()> onLoaded = nullptr);
+  void finishInit(bool available);
+  // Calls the callback of the scan request, or of all of them if `id` is -1.
+  void finishScan(int id, bool ok);
+
+  // The wireless security settings for connecting to the access point, or
+  // none if it does not take a password.
+  static QVariantMap securitySettings(const AccessPoint& accessPoint, const QString& password);
+
+  QDBusConnection bus_;
+  QString service_;
+  QString device_;
+  QString activeAccessPoint_;
+  std::unordered_map<QString, AccessPoint> accessPoints_;
+  bool initializing_ = false;
+
+  // The callbacks of the scan requests, by ID.
+  std::map<int, std::function<void(bool)>> pendingScans_;
+  int nextScanId_ = 0;
+  QTimer scanTimer_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_NETWORK_MANAGER_WIFI_H_
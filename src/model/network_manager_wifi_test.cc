@@ -0,0 +1,465 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network_manager_wifi.h"
+
+#include <map>
+#include <memory>
+
+#include <QCoreApplication>
+#include <QDBusAbstractAdaptor>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusObjectPath>
+#include <QMap>
+#include <QSignalSpy>
+#include <QString>
+#include <QTest>
+
+#include "wifi_provider.h"
+
+using NMConnectionSettings = QMap<QString, QVariantMap>;
+Q_DECLARE_METATYPE(NMConnectionSettings)
+
+namespace crystaldock {
+
+namespace {
+
+constexpr char kPath[] = "/org/freedesktop/NetworkManager";
+constexpr char kDevicePath[] = "/org/freedesktop/NetworkManager/Devices/1";
+constexpr char kAccessPointPath[] = "/org/freedesktop/NetworkManager/AccessPoint/";
+constexpr char kActiveConnectionPath[] = "/org/freedesktop/NetworkManager/ActiveConnection/1";
+
+// NM80211ApFlags and NM80211ApSecurityFlags.
+constexpr uint kPrivacy = 0x1;
+constexpr uint kPairCcmp = 0x8;
+constexpr uint kGroupCcmp = 0x80;
+constexpr uint kKeyMgmtPsk = 0x100;
+constexpr uint kKeyMgmtSae = 0x400;
+
+}  // namespace
+
+class MockManagerAdaptor : public QDBusAbstractAdaptor {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.freedesktop.NetworkManager")
+
+ public:
+  explicit MockManagerAdaptor(QObject* parent) : QDBusAbstractAdaptor(parent) {}
+
+  // The arguments of the last AddAndActivateConnection call.
+  NMConnectionSettings connectionSettings;
+  QDBusObjectPath connectionAccessPoint;
+
+ public slots:
+  QList<QDBusObjectPath> GetDevices() { return {QDBusObjectPath(kDevicePath)}; }
+
+  QDBusObjectPath AddAndActivateConnection(const NMConnectionSettings& connection,
+                                           const QDBusObjectPath& device,
+                                           const QDBusObjectPath& specificObject,
+                                           QDBusObjectPath& activeConnection) {
+    connectionSettings = connection;
+    connectionAccessPoint = specificObject;
+    activeConnection = QDBusObjectPath(kActiveConnectionPath);
+    return QDBusObjectPath("/org/freedesktop/NetworkManager/Settings/1");
+  }
+};
+
+class MockDeviceAdaptor : public QDBusAbstractAdaptor {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.freedesktop.NetworkManager.Device")
+  Q_PROPERTY(uint DeviceType MEMBER deviceType)
+
+ public:
+  MockDeviceAdaptor(QObject* parent, uint deviceType2)
+      : QDBusAbstractAdaptor(parent), deviceType(deviceType2) {}
+
+  uint deviceType;
+};
+
+class MockWirelessAdaptor : public QDBusAbstractAdaptor {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.freedesktop.NetworkManager.Device.Wireless")
+  Q_PROPERTY(QDBusObjectPath ActiveAccessPoint MEMBER activeAccessPoint)
+
+ public:
+  MockWirelessAdaptor(QObject* parent, const QDBusConnection& bus)
+      : QDBusAbstractAdaptor(parent), bus_(bus) {}
+
+  QList<QDBusObjectPath> accessPoints;
+  QDBusObjectPath activeAccessPoint{QString("/")};
+  int numScanRequests = 0;
+  // Like NetworkManager when a scan is requested too soon after the previous one.
+  bool rejectScan = false;
+
+ public slots:
+  QList<QDBusObjectPath> GetAllAccessPoints() { return accessPoints; }
+
+  void RequestScan(const QVariantMap&, const QDBusMessage& message) {
+    ++numScanRequests;
+    if (rejectScan) {
+      message.setDelayedReply(true);
+      bus_.send(message.createErrorReply(
+          "org.freedesktop.NetworkManager.Device.NotAllowed",
+          "Scanning not allowed immediately following previous scan"));
+    }
+  }
+
+ signals:
+  void AccessPointAdded(const QDBusObjectPath& path);
+  void AccessPointRemoved(const QDBusObjectPath& path);
+
+ private:
+  QDBusConnection bus_;
+};
+
+class MockAccessPointAdaptor : public QDBusAbstractAdaptor {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.freedesktop.NetworkManager.AccessPoint")
+  Q_PROPERTY(QByteArray Ssid MEMBER ssid)
+  Q_PROPERTY(uchar Strength MEMBER strength)
+  Q_PROPERTY(uint Flags MEMBER flags)
+  Q_PROPERTY(uint WpaFlags MEMBER wpaFlags)
+  Q_PROPERTY(uint RsnFlags MEMBER rsnFlags)
+
+ public:
+  MockAccessPointAdaptor(QObject* parent, const QByteArray& ssid2, uchar strength2,
+                         uint flags2, uint wpaFlags2, uint rsnFlags2)
+      : QDBusAbstractAdaptor(parent), ssid(ssid2), strength(strength2), flags(flags2),
+        wpaFlags(wpaFlags2), rsnFlags(rsnFlags2) {}
+
+  QByteArray ssid;
+  uchar strength;
+  uint flags;
+  uint wpaFlags;
+  uint rsnFlags;
+};
+
+// A mock NetworkManager service with one device.
+class MockNetworkManager {
+ public:
+  MockNetworkManager(const QDBusConnection& bus, uint deviceType) : bus_(bus) {
+    managerAdaptor_ = new MockManagerAdaptor(&manager_);
+    new MockDeviceAdaptor(&device_, deviceType);
+    wireless_ = new MockWirelessAdaptor(&device_, bus_);
+    bus_.registerObject(kPath, &manager_);
+    bus_.registerObject(kDevicePath, &device_);
+  }
+
+  ~MockNetworkManager() {
+    bus_.unregisterObject(kPath);
+    bus_.unregisterObject(kDevicePath);
+    for (const auto& [path, accessPoint] : accessPoints_) {
+      bus_.unregisterObject(path);
+    }
+  }
+
+  // An open network by default.
+  QString addAccessPoint(const QByteArray& ssid, uchar strength, uint flags = 0,
+                         uint wpaFlags = 0, uint rsnFlags = 0) {
+    const QString path = kAccessPointPath + QString::number(++numAccessPoints_);
+    auto& accessPoint = accessPoints_[path];
+    accessPoint = std::make_unique<QObject>();
+    new MockAccessPointAdaptor(accessPoint.get(), ssid, strength, flags, wpaFlags, rsnFlags);
+    bus_.registerObject(path, accessPoint.get());
+    wireless_->accessPoints.append(QDBusObjectPath(path));
+    emit wireless_->AccessPointAdded(QDBusObjectPath(path));
+    return path;
+  }
+
+  void removeAccessPoint(const QString& path) {
+    wireless_->accessPoints.removeAll(QDBusObjectPath(path));
+    bus_.unregisterObject(path);
+    accessPoints_.erase(path);
+    emit wireless_->AccessPointRemoved(QDBusObjectPath(path));
+  }
+
+  void setStrength(const QString& path, uchar strength) {
+    accessPoints_[path]->findChild<MockAccessPointAdaptor*>()->strength = strength;
+    sendPropertiesChanged(path, "org.freedesktop.NetworkManager.AccessPoint",
+                          {{"Strength", QVariant::fromValue(strength)}});
+  }
+
+  const MockManagerAdaptor* manager() const { return managerAdaptor_; }
+  MockWirelessAdaptor* wireless() { return wireless_; }
+
+  // Completes the requested scans.
+  void finishScan() {
+    sendPropertiesChanged(kDevicePath, "org.freedesktop.NetworkManager.Device.Wireless",
+                          {{"LastScan", QVariant::fromValue(++lastScan_)}});
+  }
+
+  void setActiveAccessPoint(const QString& path) {
+    wireless_->activeAccessPoint = QDBusObjectPath(path);
+    sendPropertiesChanged(kDevicePath, "org.freedesktop.NetworkManager.Device.Wireless",
+                          {{"ActiveAccessPoint", QVariant::fromValue(QDBusObjectPath(path))}});
+  }
+
+ private:
+  void sendPropertiesChanged(const QString& path, const QString& interface,
+                             const QVariantMap& changed) {
+    auto signal = QDBusMessage::createSignal(path, "org.freedesktop.DBus.Properties",
+                                             "PropertiesChanged");
+    signal << interface << changed << QStringList();
+    bus_.send(signal);
+  }
+
+  QDBusConnection bus_;
+  QObject manager_;
+  MockManagerAdaptor* managerAdaptor_;
+  QObject device_;
+  MockWirelessAdaptor* wireless_;
+  std::map<QString, std::unique_ptr<QObject>> accessPoints_;
+  int numAccessPoints_ = 0;
+  qint64 lastScan_ = 0;
+};
+
+class NetworkManagerWifiTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void init_noWifiDevice();
+  void init_accessPoints();
+  void accessPointAddedAndRemoved();
+  void strengthChanged();
+  void activeAccessPointChanged();
+  void requestScan();
+  void requestScan_rejected();
+  void connectWifi_securitySettings();
+
+ private:
+  // Initializes `wifi` against the mock service.
+  void initWifi(NetworkManagerWifi* wifi, bool expectedAvailable) {
+    QSignalSpy spy(wifi, &NetworkManagerWifi::initialized);
+    wifi->init();
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.takeFirst().at(0).toBool(), expectedAvailable);
+  }
+
+  // Connects to the network and returns the wireless security settings sent
+  // to the mock service in `settings`.
+  void connectWifi(NetworkManagerWifi* wifi, const MockNetworkManager& mock,
+                   const QString& network, const QString& password, QVariantMap* settings) {
+    bool finished = false;
+    bool success = false;
+    wifi->connectWifi(network, password, [&](bool result) {
+      finished = true;
+      success = result;
+    });
+    QTRY_VERIFY(finished);
+    QVERIFY(success);
+    *settings = mock.manager()->connectionSettings.value("802-11-wireless-security");
+  }
+
+  QDBusConnection bus_ = QDBusConnection(QString());
+  QString service_;
+};
+
+void NetworkManagerWifiTest::initTestCase() {
+  qDBusRegisterMetaType<NMConnectionSettings>();
+  // The mock service uses its own connection so that the calls go through the bus.
+  bus_ = QDBusConnection::connectToBus(QDBusConnection::SessionBus, "mock-network-manager");
+  if (!bus_.isConnected()) {
+    QSKIP("No D-Bus session bus");
+  }
+  service_ = "org.crystaldock.MockNetworkManager"
+      + QString::number(QCoreApplication::applicationPid());
+  QVERIFY(bus_.registerService(service_));
+}
+
+void NetworkManagerWifiTest::cleanupTestCase() {
+  if (bus_.isConnected()) {
+    bus_.unregisterService(service_);
+  }
+  QDBusConnection::disconnectFromBus("mock-network-manager");
+}
+
+void NetworkManagerWifiTest::init_noWifiDevice() {
+  MockNetworkManager mock(bus_, 1 /* Ethernet */);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, false);
+  QVERIFY(!wifi.isAvailable());
+}
+
+void NetworkManagerWifiTest::init_accessPoints() {
+  MockNetworkManager mock(bus_, 2 /* Wi-Fi */);
+  const QString home = mock.addAccessPoint("Home", 40);
+  mock.addAccessPoint("Cafe", 50);
+  mock.addAccessPoint("Home", 70);
+  mock.addAccessPoint("", 90);  // Hidden.
+  mock.setActiveAccessPoint(home);
+
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+  QVERIFY(wifi.isAvailable());
+
+  const WifiStatus status = wifi.status();
+  QVERIFY(status.scanned);
+  QCOMPARE(status.networks.size(), size_t(2));
+  QCOMPARE(status.networks[0].name, QString("Home"));
+  QCOMPARE(status.networks[0].signal, 70u);
+  QVERIFY(status.networks[0].inUse);
+  QCOMPARE(status.networks[1].name, QString("Cafe"));
+  QCOMPARE(status.networks[1].signal, 50u);
+  QVERIFY(!status.networks[1].inUse);
+}
+
+void NetworkManagerWifiTest::accessPointAddedAndRemoved() {
+  MockNetworkManager mock(bus_, 2);
+  mock.addAccessPoint("Cafe", 50);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+  QCOMPARE(wifi.status().networks.size(), size_t(1));
+
+  QSignalSpy spy(&wifi, &NetworkManagerWifi::networksChanged);
+  const QString office = mock.addAccessPoint("Office", 90);
+  QVERIFY(spy.wait());
+  WifiStatus status = wifi.status();
+  QCOMPARE(status.networks.size(), size_t(2));
+  QCOMPARE(status.networks[0].name, QString("Office"));
+
+  mock.removeAccessPoint(office);
+  QVERIFY(spy.wait());
+  status = wifi.status();
+  QCOMPARE(status.networks.size(), size_t(1));
+  QCOMPARE(status.networks[0].name, QString("Cafe"));
+}
+
+void NetworkManagerWifiTest::strengthChanged() {
+  MockNetworkManager mock(bus_, 2);
+  mock.addAccessPoint("Home", 70);
+  const QString cafe = mock.addAccessPoint("Cafe", 50);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+  QCOMPARE(wifi.status().networks[0].name, QString("Home"));
+
+  QSignalSpy spy(&wifi, &NetworkManagerWifi::networksChanged);
+  mock.setStrength(cafe, 80);
+  QVERIFY(spy.wait());
+  const WifiStatus status = wifi.status();
+  QCOMPARE(status.networks[0].name, QString("Cafe"));
+  QCOMPARE(status.networks[0].signal, 80u);
+}
+
+void NetworkManagerWifiTest::activeAccessPointChanged() {
+  MockNetworkManager mock(bus_, 2);
+  const QString home = mock.addAccessPoint("Home", 70);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+  QVERIFY(wifi.status().connectedNetwork() == nullptr);
+
+  QSignalSpy spy(&wifi, &NetworkManagerWifi::networksChanged);
+  mock.setActiveAccessPoint(home);
+  QVERIFY(spy.wait());
+  const WifiStatus status = wifi.status();
+  QVERIFY(status.connectedNetwork() != nullptr);
+  QCOMPARE(status.connectedNetwork()->name, QString("Home"));
+
+  mock.setActiveAccessPoint("/");
+  QVERIFY(spy.wait());
+  QVERIFY(wifi.status().connectedNetwork() == nullptr);
+}
+
+void NetworkManagerWifiTest::requestScan() {
+  MockNetworkManager mock(bus_, 2);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+
+  int numFinished = 0;
+  bool success = false;
+  wifi.requestScan([&](bool result) {
+    ++numFinished;
+    success = result;
+  });
+  QTRY_COMPARE(mock.wireless()->numScanRequests, 1);
+  // Not finished until the scan has completed.
+  QTest::qWait(100);
+  QCOMPARE(numFinished, 0);
+
+  mock.finishScan();
+  QTRY_COMPARE(numFinished, 1);
+  QVERIFY(success);
+
+  // Only called once.
+  mock.finishScan();
+  QTest::qWait(100);
+  QCOMPARE(numFinished, 1);
+}
+
+void NetworkManagerWifiTest::requestScan_rejected() {
+  MockNetworkManager mock(bus_, 2);
+  mock.wireless()->rejectScan = true;
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+
+  bool finished = false;
+  bool success = true;
+  wifi.requestScan([&](bool result) {
+    finished = true;
+    success = result;
+  });
+  QTRY_VERIFY(finished);
+  QVERIFY(!success);
+}
+
+void NetworkManagerWifiTest::connectWifi_securitySettings() {
+  MockNetworkManager mock(bus_, 2);
+  mock.addAccessPoint("Cafe", 80);
+  mock.addAccessPoint("Home", 40, kPrivacy, 0, kPairCcmp | kGroupCcmp | kKeyMgmtPsk);
+  const QString home = mock.addAccessPoint(
+      "Home", 70, kPrivacy, 0, kPairCcmp | kGroupCcmp | kKeyMgmtPsk);
+  mock.addAccessPoint("Transition", 60, kPrivacy, 0,
+                      kPairCcmp | kGroupCcmp | kKeyMgmtPsk | kKeyMgmtSae);
+  mock.addAccessPoint("Office", 50, kPrivacy, 0, kPairCcmp | kGroupCcmp | kKeyMgmtSae);
+  mock.addAccessPoint("Old", 30, kPrivacy);
+  NetworkManagerWifi wifi(QDBusConnection::sessionBus(), service_);
+  initWifi(&wifi, true);
+
+  QVariantMap settings;
+  connectWifi(&wifi, mock, "Cafe", "", &settings);
+  QVERIFY(settings.isEmpty());
+  // No security setting for an open network, even with a password.
+  connectWifi(&wifi, mock, "Cafe", "secret123", &settings);
+  QVERIFY(settings.isEmpty());
+
+  // To the strongest access point of the network.
+  connectWifi(&wifi, mock, "Home", "secret123", &settings);
+  QCOMPARE(mock.manager()->connectionAccessPoint.path(), home);
+  QCOMPARE(settings, QVariantMap({{"key-mgmt", "wpa-psk"}, {"psk", "secret123"}}));
+
+  connectWifi(&wifi, mock, "Transition", "secret123", &settings);
+  QCOMPARE(settings.value("key-mgmt").toString(), QString("wpa-psk"));
+
+  connectWifi(&wifi, mock, "Office", "secret123", &settings);
+  QCOMPARE(settings, QVariantMap({{"key-mgmt", "sae"}, {"psk", "secret123"}}));
+
+  connectWifi(&wifi, mock, "Old", "abcde", &settings);
+  QCOMPARE(settings.value("key-mgmt").toString(), QString("none"));
+  QCOMPARE(settings.value("wep-key0").toString(), QString("abcde"));
+  QCOMPARE(settings.value("wep-key-type").toUInt(), 1u);
+  connectWifi(&wifi, mock, "Old", "a passphrase", &settings);
+  QCOMPARE(settings.value("wep-key-type").toUInt(), 2u);
+}
+
+}  // namespace crystaldock
+
+QTEST_GUILESS_MAIN(crystaldock::NetworkManagerWifiTest)
+#include "network_manager_wifi_test.moc"
@@ -0,0 +1,65 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_STATUS_HUB_H_
+#define CRYSTALDOCK_STATUS_HUB_H_
+
+#include <vector>
+
+#include "battery_provider.h"
+#include "keyboard_layout_provider.h"
+#include "status_provider.h"
+#include "volume_provider.h"
+#include "wifi_provider.h"
+
+namespace crystaldock {
+
+// The process-wide status providers, one per source.
+//
+// Every dock item that shows a status subscribes to the provider here instead
+// of fetching the status itself, so the cost of fetching does not grow with
+// the number of docks.
+class StatusHub {
+ public:
+  static StatusHub* self() {
+    static StatusHub self;
+    return &self;
+  }
+
+  VolumeProvider* volume() { return &volume_; }
+  BatteryProvider* battery() { return &battery_; }
+  WifiProvider* wifi() { return &wifi_; }
+  KeyboardLayoutProvider* keyboardLayout() { return &keyboardLayout_; }
+
+  // For inspecting the stats of all the providers.
+  std::vector<const StatusProvider*> providers() const {
+    return {&volume_, &battery_, &wifi_, &keyboardLayout_};
+  }
+
+ private:
+  StatusHub() : battery_(BatteryProvider::kPowerSupplyDir, /*useUPower=*/true) {}
+
+  VolumeProvider volume_;
+  BatteryProvider battery_;
+  WifiProvider wifi_;
+  KeyboardLayoutProvider keyboardLayout_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_STATUS_HUB_H_
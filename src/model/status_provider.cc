@@ -0,0 +1,72 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "status_provider.h"
+
+namespace crystaldock {
+
+void StatusProvider::subscribe() {
+  if (numSubscribers_++ == 0) {
+    start();
+  }
+}
+
+void StatusProvider::unsubscribe() {
+  if (numSubscribers_ > 0 && --numSubscribers_ == 0) {
+    stop();
+  }
+}
+
+StatusProviderStats StatusProvider::stats() const {
+  pruneFetchTimes();
+  return {numSubscribers_, numFetches_, static_cast<int>(fetchTimes_.size()),
+          lastFetchLatencyMs_};
+}
+
+void StatusProvider::fetchStarted() {
+  if (!clock_.isValid()) {
+    clock_.start();
+  }
+  fetchStartMs_ = clock_.elapsed();
+}
+
+void StatusProvider::fetchFinished() {
+  if (fetchStartMs_ < 0) {
+    return;
+  }
+
+  const qint64 now = clock_.elapsed();
+  lastFetchLatencyMs_ = static_cast<int>(now - fetchStartMs_);
+  fetchStartMs_ = -1;
+  ++numFetches_;
+  fetchTimes_.push_back(now);
+  pruneFetchTimes();
+}
+
+void StatusProvider::pruneFetchTimes() const {
+  if (!clock_.isValid()) {
+    return;
+  }
+
+  const qint64 now = clock_.elapsed();
+  while (!fetchTimes_.empty() && now - fetchTimes_.front() > kRateWindowMs) {
+    fetchTimes_.pop_front();
+  }
+}
+
+}  // namespace crystaldock
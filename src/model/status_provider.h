@@ -0,0 +1,89 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_STATUS_PROVIDER_H_
+#define CRYSTALDOCK_STATUS_PROVIDER_H_
+
+#include <deque>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+
+namespace crystaldock {
+
+struct StatusProviderStats {
+  int numSubscribers = 0;
+  int numFetches = 0;
+  // Fetches finished in the last minute.
+  int fetchesPerMinute = 0;
+  // -1 if there has not been any fetch.
+  int lastFetchLatencyMs = -1;
+};
+
+// Base class of the sources of system status (volume, battery etc.) shown by
+// the dock items.
+//
+// There is one provider per source for the whole process (see StatusHub), no
+// matter how many docks show it. It fetches the status only while there are
+// subscribers, and broadcasts it to all of them with a provider-specific
+// signal. The status is published as values or shared immutable snapshots,
+// so that subscribers never see it change under them.
+class StatusProvider : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit StatusProvider(const QString& name) : name_(name) {}
+  virtual ~StatusProvider() = default;
+
+  const QString& name() const { return name_; }
+
+  void subscribe();
+  void unsubscribe();
+  bool hasSubscribers() const { return numSubscribers_ > 0; }
+
+  StatusProviderStats stats() const;
+
+ protected:
+  // Called on the first subscription and after the last unsubscription.
+  virtual void start() = 0;
+  virtual void stop() = 0;
+
+  // Record the timing of fetches for the stats.
+  void fetchStarted();
+  void fetchFinished();
+
+ private:
+  static constexpr qint64 kRateWindowMs = 60000;
+
+  void pruneFetchTimes() const;
+
+  QString name_;
+  int numSubscribers_ = 0;
+
+  QElapsedTimer clock_;
+  qint64 fetchStartMs_ = -1;
+  int numFetches_ = 0;
+  int lastFetchLatencyMs_ = -1;
+  // Finish times of the fetches in the rate window.
+  mutable std::deque<qint64> fetchTimes_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_STATUS_PROVIDER_H_
@@ -0,0 +1,614 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trash_jobs.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+namespace crystaldock {
+
+namespace {
+
+// The number of deletions between progress reports.
+constexpr int kBatchSize = 256;
+constexpr size_t kCopyChunkSize = 1 << 30;
+constexpr size_t kCopyBufferSize = 128 * 1024;
+// Up to "name_<kMaxNameAttempts>.ext" for files with the same name.
+constexpr int kMaxNameAttempts = 10000;
+constexpr char kDirectorySizesFile[] = "/directorysizes";
+
+// An entry of the directorysizes cache.
+struct DirectorySize {
+  qint64 size = 0;
+  // The modification time of the directory's info file, in seconds.
+  qint64 mtime = 0;
+
+  bool operator==(const DirectorySize& other) const = default;
+};
+
+// By directory name.
+using DirectorySizes = std::map<QString, DirectorySize>;
+
+bool isDotOrDotDot(const char* name) {
+  return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+void printError(const char* operation, const QString& path) {
+  std::cerr << "Trash: failed to " << operation << " " << path.toStdString() << ": "
+            << std::strerror(errno) << std::endl;
+}
+
+// Lists the entries of the directory, except "." and "..".
+std::vector<std::string> listDir(int dirFd) {
+  std::vector<std::string> names;
+  // fdopendir() takes over the fd, so it works on a duplicate.
+  const int fd = dup(dirFd);
+  if (fd < 0) {
+    return names;
+  }
+  DIR* dir = fdopendir(fd);
+  if (dir == nullptr) {
+    close(fd);
+    return names;
+  }
+  rewinddir(dir);
+  while (const dirent* entry = readdir(dir)) {
+    if (!isDotOrDotDot(entry->d_name)) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+  return names;
+}
+
+// Removes the entry, recursively for directories. Counts the removed entries.
+bool removeAt(int dirFd, const char* name, int* numRemoved) {
+  if (unlinkat(dirFd, name, 0) == 0) {
+    ++*numRemoved;
+    return true;
+  }
+  if (errno != EISDIR && errno != EPERM) {
+    return false;
+  }
+
+  const int fd = openat(dirFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = true;
+  for (const auto& entry : listDir(fd)) {
+    ok = removeAt(fd, entry.c_str(), numRemoved) && ok;
+  }
+  close(fd);
+  if (unlinkat(dirFd, name, AT_REMOVEDIR) != 0) {
+    return false;
+  }
+  ++*numRemoved;
+  return ok;
+}
+
+bool copyWithReadWrite(int in, int out) {
+  std::vector<char> buffer(kCopyBufferSize);
+  while (true) {
+    const ssize_t numRead = read(in, buffer.data(), buffer.size());
+    if (numRead == 0) {
+      return true;
+    } else if (numRead < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    for (ssize_t written = 0; written < numRead;) {
+      const ssize_t n = write(out, buffer.data() + written, numRead - written);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      written += n;
+    }
+  }
+}
+
+bool copyFileContents(int in, int out) {
+  // In the kernel, and without copying at all on file systems with reflinks.
+  while (true) {
+    const ssize_t n = copy_file_range(in, nullptr, out, nullptr, kCopyChunkSize, 0);
+    if (n == 0) {
+      return true;
+    } else if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) {
+        // Not supported between these file systems.
+        return copyWithReadWrite(in, out);
+      }
+      return false;
+    }
+  }
+}
+
+// Copies the entry, recursively for directories, keeping the permissions.
+bool copyAt(int srcDirFd, const char* srcName, int dstDirFd, const char* dstName) {
+  struct stat st;
+  if (fstatat(srcDirFd, srcName, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+    return false;
+  }
+
+  if (S_ISREG(st.st_mode)) {
+    const int in = openat(srcDirFd, srcName, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (in < 0) {
+      return false;
+    }
+    const int out = openat(dstDirFd, dstName, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                           st.st_mode & 07777);
+    if (out < 0) {
+      close(in);
+      return false;
+    }
+    // Also the permissions masked by the umask.
+    const bool ok = copyFileContents(in, out) && fchmod(out, st.st_mode & 07777) == 0;
+    close(in);
+    return (close(out) == 0) && ok;
+  } else if (S_ISDIR(st.st_mode)) {
+    if (mkdirat(dstDirFd, dstName, 0700) != 0) {
+      return false;
+    }
+    const int srcFd = openat(srcDirFd, srcName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    const int dstFd = openat(dstDirFd, dstName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    bool ok = srcFd >= 0 && dstFd >= 0;
+    if (ok) {
+      for (const auto& entry : listDir(srcFd)) {
+        if (!copyAt(srcFd, entry.c_str(), dstFd, entry.c_str())) {
+          ok = false;
+          break;
+        }
+      }
+      ok = ok && fchmod(dstFd, st.st_mode & 07777) == 0;
+    }
+    if (srcFd >= 0) close(srcFd);
+    if (dstFd >= 0) close(dstFd);
+    return ok;
+  } else if (S_ISLNK(st.st_mode)) {
+    std::string target(st.st_size + 1, '\0');
+    const ssize_t size = readlinkat(srcDirFd, srcName, target.data(), target.size());
+    if (size < 0 || static_cast<size_t>(size) >= target.size()) {
+      return false;
+    }
+    target.resize(size);
+    return symlinkat(target.c_str(), dstDirFd, dstName) == 0;
+  }
+
+  // Sockets, devices etc.
+  errno = ENOTSUP;
+  return false;
+}
+
+// The disk usage of the entry like "du -B1", recursively for directories.
+qint64 diskUsageAt(int dirFd, const char* name) {
+  struct stat st;
+  if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+    return 0;
+  }
+  qint64 size = static_cast<qint64>(st.st_blocks) * 512;
+  if (S_ISDIR(st.st_mode)) {
+    const int fd = openat(dirFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0) {
+      for (const auto& entry : listDir(fd)) {
+        size += diskUsageAt(fd, entry.c_str());
+      }
+      close(fd);
+    }
+  }
+  return size;
+}
+
+// The modification time of the item's info file, or -1 if there is none.
+qint64 getInfoMtime(const QString& trashPath, const QString& name) {
+  struct stat st;
+  const QByteArray infoPath = QFile::encodeName(trashPath + "/info/" + name + ".trashinfo");
+  return stat(infoPath.constData(), &st) == 0 ? static_cast<qint64>(st.st_mtime) : -1;
+}
+
+// Each line is "<size> <mtime> <percent-encoded name>".
+DirectorySizes readDirectorySizes(const QString& trashPath) {
+  DirectorySizes sizes;
+  QFile file(trashPath + kDirectorySizesFile);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return sizes;
+  }
+  while (!file.atEnd()) {
+    const QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+    if (fields.size() != 3) {
+      continue;
+    }
+    bool sizeOk = false;
+    bool mtimeOk = false;
+    const DirectorySize size{fields[0].toLongLong(&sizeOk), fields[1].toLongLong(&mtimeOk)};
+    if (sizeOk && mtimeOk) {
+      sizes[QFile::decodeName(QByteArray::fromPercentEncoding(fields[2]))] = size;
+    }
+  }
+  return sizes;
+}
+
+// Replaces the file atomically, as other applications may be reading it.
+void writeDirectorySizes(const QString& trashPath, const DirectorySizes& sizes) {
+  QSaveFile file(trashPath + kDirectorySizesFile);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+  for (const auto& [name, size] : sizes) {
+    file.write(QByteArray::number(size.size) + ' ' + QByteArray::number(size.mtime) + ' '
+               + QFile::encodeName(name).toPercentEncoding("/") + '\n');
+  }
+  file.commit();
+}
+
+// Makes sure that the trash and its subdirectories exist and are usable.
+bool ensureTrashDir(const QString& path) {
+  const QByteArray dir = QFile::encodeName(path);
+  if (mkdir(dir.constData(), 0700) != 0 && errno != EEXIST) {
+    return false;
+  }
+  struct stat st;
+  if (lstat(dir.constData(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid()) {
+    return false;
+  }
+  for (const char* subdir : {"/files", "/info"}) {
+    if (mkdir((dir + subdir).constData(), 0700) != 0 && errno != EEXIST) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the mount point of the directory, given its device.
+QString findTopDir(const QString& dir, dev_t device) {
+  QString topDir = QDir::cleanPath(dir);
+  while (topDir != "/") {
+    const QString parent = QFileInfo(topDir).path();
+    struct stat st;
+    if (stat(QFile::encodeName(parent).constData(), &st) != 0 || st.st_dev != device) {
+      break;
+    }
+    topDir = parent;
+  }
+  return topDir;
+}
+
+QString findMountTrash(const QString& topDir) {
+  const QString uid = QString::number(getuid());
+  // $topdir/.Trash/$uid, if the administrator has set up $topdir/.Trash.
+  const QString adminTrash = (topDir == "/" ? "" : topDir) + "/.Trash";
+  struct stat st;
+  if (lstat(QFile::encodeName(adminTrash).constData(), &st) == 0 && S_ISDIR(st.st_mode)
+      && (st.st_mode & S_ISVTX)) {
+    const QString trash = adminTrash + "/" + uid;
+    if (ensureTrashDir(trash)) {
+      return trash;
+    }
+  }
+
+  const QString trash = (topDir == "/" ? "" : topDir) + "/.Trash-" + uid;
+  return ensureTrashDir(trash) ? trash : QString();
+}
+
+}  // namespace
+
+TrashJobs::TrashJobs() {
+  pool_.setMaxThreadCount(1);
+}
+
+void TrashJobs::moveToTrash(const QStringList& filePaths) {
+  runJob([this, filePaths] {
+    std::set<QString> mountTrashPaths;
+    for (int i = 0; i < filePaths.size(); ++i) {
+      setProgress(QString("Moving to trash: %1 of %2").arg(i + 1).arg(filePaths.size()));
+      const TrashDir trash = findTrash(filePaths[i]);
+      const QString name = trash.isEmpty() ? QString() : trashFile(filePaths[i], trash);
+      if (name.isEmpty()) {
+        std::cerr << "Failed to move " << filePaths[i].toStdString() << " to trash" << std::endl;
+        continue;
+      }
+      if (!trash.topDir.isEmpty()) {
+        mountTrashPaths.insert(trash.path);
+      }
+      if (QFileInfo(trash.path + "/files/" + name).isDir()) {
+        addDirectorySize(trash.path, name);
+      }
+    }
+
+    QMetaObject::invokeMethod(this, [this, mountTrashPaths] {
+      mountTrashPaths_.insert(mountTrashPaths.begin(), mountTrashPaths.end());
+    }, Qt::QueuedConnection);
+  });
+}
+
+void TrashJobs::emptyTrash() {
+  std::set<QString> trashPaths = mountTrashPaths_;
+  trashPaths.insert(homeTrashPath());
+  runJob([this, trashPaths] {
+    for (const auto& trashPath : trashPaths) {
+      deleteTrashContents(trashPath, [this](int numDeleted, int total) {
+        setProgress(QString("Emptying: %1%").arg(total > 0 ? numDeleted * 100 / total : 100));
+      });
+      QFile::remove(trashPath + kDirectorySizesFile);
+    }
+  });
+}
+
+void TrashJobs::updateSize() {
+  // Coalesces the updates, e.g. for the many changes while emptying.
+  if (sizeUpdateQueued_.exchange(true)) {
+    return;
+  }
+  pool_.start([this] {
+    sizeUpdateQueued_ = false;
+    const TrashSize size = computeSize(homeTrashPath());
+    QMetaObject::invokeMethod(this, [this, size] {
+      if (size != size_) {
+        size_ = size;
+        emit sizeChanged(size_);
+      }
+    }, Qt::QueuedConnection);
+  });
+}
+
+void TrashJobs::runJob(std::function<void()> job) {
+  ++numPendingJobs_;
+  pool_.start([this, job] {
+    job();
+    QMetaObject::invokeMethod(this, [this] {
+      if (--numPendingJobs_ == 0) {
+        progress_.clear();
+      }
+      emit progressChanged(progress_);
+      emit jobFinished();
+    }, Qt::QueuedConnection);
+  });
+}
+
+void TrashJobs::setProgress(const QString& progress) {
+  QMetaObject::invokeMethod(this, [this, progress] {
+    progress_ = progress;
+    emit progressChanged(progress_);
+  }, Qt::QueuedConnection);
+}
+
+/* static */ QString TrashJobs::homeTrashPath() {
+  return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Trash";
+}
+
+/* static */ TrashDir TrashJobs::findTrash(const QString& filePath) {
+  const TrashDir homeTrash{homeTrashPath(), {}};
+  if (!ensureTrashDir(homeTrash.path)) {
+    return {};
+  }
+
+  // The file's directory rather than the file, which could be a mount point.
+  const QString dir = QFileInfo(filePath).absolutePath();
+  struct stat dirStat;
+  struct stat homeTrashStat;
+  if (stat(QFile::encodeName(dir).constData(), &dirStat) != 0
+      || stat(QFile::encodeName(homeTrash.path).constData(), &homeTrashStat) != 0) {
+    return {};
+  }
+  if (dirStat.st_dev == homeTrashStat.st_dev) {
+    return homeTrash;
+  }
+
+  const QString topDir = findTopDir(dir, dirStat.st_dev);
+  const QString mountTrash = findMountTrash(topDir);
+  // Otherwise the file is copied to the home trash.
+  return mountTrash.isEmpty() ? homeTrash : TrashDir{mountTrash, topDir};
+}
+
+/* static */ QString TrashJobs::trashFile(const QString& filePath, const TrashDir& trash) {
+  const QFileInfo fileInfo(filePath);
+  const QByteArray source = QFile::encodeName(fileInfo.absoluteFilePath());
+  struct stat st;
+  if (lstat(source.constData(), &st) != 0) {
+    printError("find", filePath);
+    return {};
+  }
+
+  const QString originalPath = trash.topDir.isEmpty()
+      ? fileInfo.absoluteFilePath()
+      : QDir(trash.topDir).relativeFilePath(fileInfo.absoluteFilePath());
+  const QByteArray info = "[Trash Info]\nPath="
+      + QUrl::toPercentEncoding(originalPath, "/")
+      + "\nDeletionDate="
+      + QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss").toUtf8() + "\n";
+
+  for (int counter = 0; counter <= kMaxNameAttempts; ++counter) {
+    QString name = fileInfo.fileName();
+    if (counter > 0) {
+      const QString baseName = fileInfo.baseName();
+      const QString suffix = fileInfo.completeSuffix();
+      name = suffix.isEmpty() ? QString("%1_%2").arg(baseName).arg(counter)
+                              : QString("%1_%2.%3").arg(baseName).arg(counter).arg(suffix);
+    }
+    const QByteArray dest = QFile::encodeName(trash.path + "/files/" + name);
+    const QByteArray infoPath = QFile::encodeName(trash.path + "/info/" + name + ".trashinfo");
+
+    // Creating the info file first reserves the name, as the spec recommends.
+    const int infoFd = open(infoPath.constData(),
+                            O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (infoFd < 0) {
+      if (errno == EEXIST) continue;
+      printError("create info for", filePath);
+      return {};
+    }
+    const bool infoWritten = write(infoFd, info.constData(), info.size()) == info.size();
+    if (close(infoFd) != 0 || !infoWritten) {
+      printError("write info for", filePath);
+      unlink(infoPath.constData());
+      return {};
+    }
+
+    if (renameat2(AT_FDCWD, source.constData(), AT_FDCWD, dest.constData(),
+                  RENAME_NOREPLACE) == 0) {
+      return name;
+    }
+    if (errno == EINVAL || errno == ENOSYS) {
+      // RENAME_NOREPLACE is not supported by the file system.
+      if (access(dest.constData(), F_OK) == 0) {
+        errno = EEXIST;
+      } else if (rename(source.constData(), dest.constData()) == 0) {
+        return name;
+      }
+    }
+    if (errno == EEXIST) {
+      // An entry without an info file.
+      unlink(infoPath.constData());
+      continue;
+    }
+    if (errno == EXDEV) {
+      if (moveAcrossDevices(source, dest)) {
+        return name;
+      }
+    } else {
+      printError("move", filePath);
+    }
+    unlink(infoPath.constData());
+    return {};
+  }
+  return {};
+}
+
+/* static */ bool TrashJobs::moveAcrossDevices(const QByteArray& source,
+                                               const QByteArray& dest) {
+  const QString sourcePath = QFile::decodeName(source);
+  if (!copyAt(AT_FDCWD, source.constData(), AT_FDCWD, dest.constData())) {
+    printError("copy", sourcePath);
+    int numRemoved = 0;
+    removeAt(AT_FDCWD, dest.constData(), &numRemoved);
+    return false;
+  }
+
+  int numRemoved = 0;
+  if (!removeAt(AT_FDCWD, source.constData(), &numRemoved)) {
+    printError("delete the original of", sourcePath);
+  }
+  return true;
+}
+
+/* static */ bool TrashJobs::deleteTrashContents(
+    const QString& trashPath, const std::function<void(int, int)>& onProgress) {
+  // The files before their info files, so that no file is left without one.
+  std::vector<std::pair<int, std::vector<std::string>>> dirs;
+  int total = 0;
+  for (const char* subdir : {"/files", "/info"}) {
+    const QByteArray path = QFile::encodeName(trashPath + subdir);
+    const int fd = open(path.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    dirs.emplace_back(fd, listDir(fd));
+    total += static_cast<int>(dirs.back().second.size());
+  }
+
+  bool ok = true;
+  int numDeleted = 0;
+  int numRemoved = 0;
+  int numReported = 0;
+  for (const auto& [fd, entries] : dirs) {
+    for (const auto& entry : entries) {
+      if (!removeAt(fd, entry.c_str(), &numRemoved)) {
+        printError("delete", trashPath + "/" + QString::fromStdString(entry));
+        ok = false;
+      }
+      ++numDeleted;
+      if (onProgress && numRemoved - numReported >= kBatchSize) {
+        numReported = numRemoved;
+        onProgress(numDeleted, total);
+      }
+    }
+    close(fd);
+  }
+  if (onProgress) {
+    onProgress(total, total);
+  }
+  return ok;
+}
+
+/* static */ TrashSize TrashJobs::computeSize(const QString& trashPath) {
+  TrashSize trashSize;
+  const QByteArray filesPath = QFile::encodeName(trashPath + "/files");
+  const int fd = open(filesPath.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return trashSize;
+  }
+
+  const DirectorySizes cachedSizes = readDirectorySizes(trashPath);
+  // Without the directories that are no longer in the trash.
+  DirectorySizes sizes;
+  for (const auto& entry : listDir(fd)) {
+    struct stat st;
+    if (fstatat(fd, entry.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+      continue;
+    }
+    ++trashSize.numItems;
+    if (!S_ISDIR(st.st_mode)) {
+      trashSize.numBytes += static_cast<qint64>(st.st_blocks) * 512;
+      continue;
+    }
+
+    // Only the directories are cached, as they are expensive to compute.
+    const QString name = QFile::decodeName(entry.c_str());
+    const qint64 mtime = getInfoMtime(trashPath, name);
+    const auto it = cachedSizes.find(name);
+    const DirectorySize size = (it != cachedSizes.end() && it->second.mtime == mtime)
+        ? it->second
+        : DirectorySize{diskUsageAt(fd, entry.c_str()), mtime};
+    sizes[name] = size;
+    trashSize.numBytes += size.size;
+  }
+  close(fd);
+
+  if (sizes != cachedSizes) {
+    writeDirectorySizes(trashPath, sizes);
+  }
+  return trashSize;
+}
+
+/* static */ void TrashJobs::addDirectorySize(const QString& trashPath, const QString& name) {
+  DirectorySizes sizes = readDirectorySizes(trashPath);
+  const QByteArray path = QFile::encodeName(trashPath + "/files/" + name);
+  sizes[name] = {diskUsageAt(AT_FDCWD, path.constData()), getInfoMtime(trashPath, name)};
+  writeDirectorySizes(trashPath, sizes);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,145 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_TRASH_JOBS_H_
+#define CRYSTALDOCK_TRASH_JOBS_H_
+
+#include <atomic>
+#include <functional>
+#include <set>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+namespace crystaldock {
+
+// A trash directory, with its "files" and "info" subdirectories.
+struct TrashDir {
+  QString path;
+  // The top directory of the mount for a per-mount trash, or empty for the
+  // home trash. The paths in the info files are relative to it.
+  QString topDir;
+
+  bool isEmpty() const { return path.isEmpty(); }
+};
+
+// The number of items in a trash and their disk usage.
+struct TrashSize {
+  int numItems = 0;
+  qint64 numBytes = 0;
+
+  bool operator==(const TrashSize& other) const = default;
+};
+
+// Trash operations, following the FreeDesktop.org trash specification.
+//
+// The operations run one by one on a background thread, and report their
+// progress to the GUI thread.
+class TrashJobs : public QObject {
+  Q_OBJECT
+
+ public:
+  static TrashJobs* self() {
+    static TrashJobs self;
+    return &self;
+  }
+
+  // Queues moving the files to the trash.
+  void moveToTrash(const QStringList& filePaths);
+
+  // Queues deleting the contents of the home trash and of the per-mount
+  // trashes that have been used.
+  void emptyTrash();
+
+  bool isBusy() const { return numPendingJobs_ > 0; }
+
+  // The progress of the running job, e.g. "Emptying: 42%".
+  const QString& progress() const { return progress_; }
+
+  // Queues updating the size of the home trash, after the queued jobs.
+  // Emits sizeChanged() if it has changed.
+  void updateSize();
+
+  const TrashSize& size() const { return size_; }
+
+  static QString homeTrashPath();
+
+  // Finds the trash for the file, creating it if needed: the home trash if
+  // the file is on the same device, otherwise the trash of the file's mount
+  // ($topdir/.Trash/$uid or $topdir/.Trash-$uid). Falls back to the home
+  // trash if the latter cannot be used.
+  static TrashDir findTrash(const QString& filePath);
+
+  // Moves the file or directory to the trash and writes its info file.
+  // Renames on the same device, or copies then deletes across devices.
+  // Returns the name in the trash, or an empty string on failure.
+  static QString trashFile(const QString& filePath, const TrashDir& trash);
+
+  // Copies the file or directory tree to `dest`, which must not exist, keeping
+  // the permissions and symlinks, then deletes the source. The source is only
+  // deleted once the whole tree has been copied, otherwise the partial copy is
+  // deleted instead. Returns whether it has been copied.
+  static bool moveAcrossDevices(const QByteArray& source, const QByteArray& dest);
+
+  // Deletes the contents of the trash. `onProgress` is called with the number
+  // of deleted top-level entries and the total after each batch of deletions.
+  static bool deleteTrashContents(const QString& trashPath,
+                                  const std::function<void(int, int)>& onProgress = nullptr);
+
+  // Computes the size of the trash. The sizes of the directories come from
+  // the trash's directorysizes cache if still valid, and the cache is updated
+  // with the directories that have been computed or removed.
+  static TrashSize computeSize(const QString& trashPath);
+
+  // Adds the trashed directory to the directorysizes cache of the trash.
+  static void addDirectorySize(const QString& trashPath, const QString& name);
+
+ signals:
+  void progressChanged(const QString& progress);
+  // After each job.
+  void jobFinished();
+  void sizeChanged(const TrashSize& size);
+
+ private:
+  TrashJobs();
+
+  // Runs the job on the background thread, after the queued ones.
+  void runJob(std::function<void()> job);
+
+  // Can be called from the background thread.
+  void setProgress(const QString& progress);
+
+  int numPendingJobs_ = 0;
+  QString progress_;
+  // The per-mount trashes that have been used.
+  std::set<QString> mountTrashPaths_;
+
+  TrashSize size_;
+  // Whether a size update is waiting to run.
+  std::atomic<bool> sizeUpdateQueued_ = false;
+
+  // For the jobs to run one by one. Last, so that the running job finishes
+  // before the other members are destroyed.
+  QThreadPool pool_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_TRASH_JOBS_H_
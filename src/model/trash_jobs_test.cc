@@ -0,0 +1,230 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trash_jobs.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTest>
+
+namespace crystaldock {
+
+class TrashJobsTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void trashFile();
+  void trashFile_sameName();
+  void trashFile_mountTrash();
+  void moveAcrossDevices();
+  void moveAcrossDevices_unsupportedFile();
+  void deleteTrashContents();
+  void computeSize_directorySizes();
+
+ private:
+  // Creates a trash in the temporary dir.
+  TrashDir createTrash(const QTemporaryDir& dir, const QString& topDir = "") {
+    const QString path = dir.path() + "/Trash";
+    QDir().mkpath(path + "/files");
+    QDir().mkpath(path + "/info");
+    return {path, topDir};
+  }
+
+  void writeFile(const QString& path) {
+    QVERIFY(QDir().mkpath(QFileInfo(path).path()));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("content");
+  }
+
+  QByteArray readFile(const QString& path) {
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+  }
+
+  // The permission bits, or -1 if the entry does not exist.
+  int mode(const QString& path) {
+    struct stat st;
+    return lstat(QFile::encodeName(path).constData(), &st) == 0 ? (st.st_mode & 07777) : -1;
+  }
+
+  // Creates a tree with a regular file, an executable, a subdirectory with a
+  // file and a symlink.
+  void createTree(const QString& path) {
+    writeFile(path + "/file");
+    QVERIFY(chmod(QFile::encodeName(path + "/file").constData(), 0664) == 0);
+    writeFile(path + "/run.sh");
+    QVERIFY(chmod(QFile::encodeName(path + "/run.sh").constData(), 0755) == 0);
+    writeFile(path + "/sub/private");
+    QVERIFY(chmod(QFile::encodeName(path + "/sub/private").constData(), 0600) == 0);
+    QVERIFY(chmod(QFile::encodeName(path + "/sub").constData(), 0750) == 0);
+    QVERIFY(QFile::link("sub/private", path + "/link"));
+  }
+};
+
+void TrashJobsTest::trashFile() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const TrashDir trash = createTrash(dir);
+  const QString filePath = dir.path() + "/my file.txt";
+  writeFile(filePath);
+
+  QCOMPARE(TrashJobs::trashFile(filePath, trash), QString("my file.txt"));
+  QVERIFY(!QFile::exists(filePath));
+  QCOMPARE(readFile(trash.path + "/files/my file.txt"), QByteArray("content"));
+  const QByteArray info = readFile(trash.path + "/info/my file.txt.trashinfo");
+  QVERIFY(info.startsWith("[Trash Info]\n"));
+  QVERIFY(info.contains("\nPath=" + QFile::encodeName(dir.path()).toPercentEncoding("/")
+                        + "/my%20file.txt\n"));
+  QVERIFY(info.contains("\nDeletionDate="));
+}
+
+void TrashJobsTest::trashFile_sameName() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const TrashDir trash = createTrash(dir);
+  writeFile(dir.path() + "/a/notes.tar.gz");
+  writeFile(dir.path() + "/b/notes.tar.gz");
+
+  QCOMPARE(TrashJobs::trashFile(dir.path() + "/a/notes.tar.gz", trash), QString("notes.tar.gz"));
+  QCOMPARE(TrashJobs::trashFile(dir.path() + "/b/notes.tar.gz", trash),
+           QString("notes_1.tar.gz"));
+  QVERIFY(QFile::exists(trash.path + "/info/notes_1.tar.gz.trashinfo"));
+
+  // A missing file.
+  QVERIFY(TrashJobs::trashFile(dir.path() + "/c/notes.tar.gz", trash).isEmpty());
+}
+
+void TrashJobsTest::trashFile_mountTrash() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const TrashDir trash = createTrash(dir, dir.path());
+  writeFile(dir.path() + "/projects/dock/file");
+
+  QCOMPARE(TrashJobs::trashFile(dir.path() + "/projects/dock", trash), QString("dock"));
+  QCOMPARE(readFile(trash.path + "/files/dock/file"), QByteArray("content"));
+  // Relative to the top directory.
+  QVERIFY(readFile(trash.path + "/info/dock.trashinfo").contains("\nPath=projects/dock\n"));
+}
+
+void TrashJobsTest::moveAcrossDevices() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString source = dir.path() + "/source";
+  const QString dest = dir.path() + "/dest";
+  createTree(source);
+
+  QVERIFY(TrashJobs::moveAcrossDevices(QFile::encodeName(source), QFile::encodeName(dest)));
+  QVERIFY(!QFileInfo::exists(source));
+  QCOMPARE(readFile(dest + "/file"), QByteArray("content"));
+  QCOMPARE(readFile(dest + "/sub/private"), QByteArray("content"));
+  // Not masked by the umask.
+  QCOMPARE(mode(dest + "/file"), 0664);
+  QCOMPARE(mode(dest + "/run.sh"), 0755);
+  QCOMPARE(mode(dest + "/sub"), 0750);
+  QCOMPARE(mode(dest + "/sub/private"), 0600);
+  // The link itself, not its target.
+  QVERIFY(QFileInfo(dest + "/link").isSymLink());
+  QCOMPARE(QFile::symLinkTarget(dest + "/link"), dest + "/sub/private");
+}
+
+void TrashJobsTest::moveAcrossDevices_unsupportedFile() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString source = dir.path() + "/source";
+  const QString dest = dir.path() + "/dest";
+  createTree(source);
+  // Named pipes cannot be copied.
+  QVERIFY(mkfifo(QFile::encodeName(source + "/sub/pipe").constData(), 0600) == 0);
+
+  // The source is kept and the partial copy is deleted.
+  QVERIFY(!TrashJobs::moveAcrossDevices(QFile::encodeName(source), QFile::encodeName(dest)));
+  QVERIFY(!QFileInfo::exists(dest));
+  QCOMPARE(readFile(source + "/file"), QByteArray("content"));
+  QCOMPARE(readFile(source + "/sub/private"), QByteArray("content"));
+  QVERIFY(QFileInfo(source + "/link").isSymLink());
+  QCOMPARE(mode(source + "/sub/pipe"), 0600);
+}
+
+void TrashJobsTest::deleteTrashContents() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const TrashDir trash = createTrash(dir);
+  for (int i = 0; i < 3; ++i) {
+    writeFile(dir.path() + QString("/dir%1/sub/file").arg(i));
+    QVERIFY(!TrashJobs::trashFile(dir.path() + QString("/dir%1").arg(i), trash).isEmpty());
+  }
+
+  int lastNumDeleted = -1;
+  int lastTotal = -1;
+  QVERIFY(TrashJobs::deleteTrashContents(trash.path, [&](int numDeleted, int total) {
+    lastNumDeleted = numDeleted;
+    lastTotal = total;
+  }));
+  // The 3 entries and their info files.
+  QCOMPARE(lastNumDeleted, 6);
+  QCOMPARE(lastTotal, 6);
+  QVERIFY(QDir(trash.path + "/files").isEmpty());
+  QVERIFY(QDir(trash.path + "/info").isEmpty());
+}
+
+void TrashJobsTest::computeSize_directorySizes() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const TrashDir trash = createTrash(dir);
+  QCOMPARE(TrashJobs::computeSize(trash.path), TrashSize());
+
+  writeFile(dir.path() + "/file");
+  writeFile(dir.path() + "/my dir/file");
+  QVERIFY(!TrashJobs::trashFile(dir.path() + "/file", trash).isEmpty());
+  QVERIFY(!TrashJobs::trashFile(dir.path() + "/my dir", trash).isEmpty());
+  TrashJobs::addDirectorySize(trash.path, "my dir");
+
+  const QString cachePath = trash.path + "/directorysizes";
+  QByteArray cache = readFile(cachePath);
+  const QList<QByteArray> fields = cache.trimmed().split(' ');
+  QCOMPARE(fields.size(), 3);
+  QCOMPARE(fields[2], QByteArray("my%20dir"));
+  const TrashSize size = TrashJobs::computeSize(trash.path);
+  QCOMPARE(size.numItems, 2);
+  QVERIFY(size.numBytes >= fields[0].toLongLong());
+
+  // The directory's size comes from the cache while its info file is unchanged.
+  {
+    QFile file(cachePath);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("1000000000 " + fields[1] + " my%20dir\n");
+  }
+  QVERIFY(TrashJobs::computeSize(trash.path).numBytes >= 1000000000);
+
+  // Entries for directories no longer in the trash are dropped.
+  QVERIFY(TrashJobs::deleteTrashContents(trash.path));
+  QCOMPARE(TrashJobs::computeSize(trash.path), TrashSize());
+  QVERIFY(readFile(cachePath).isEmpty());
+}
+
+}  // namespace crystaldock
+
+QTEST_GUILESS_MAIN(crystaldock::TrashJobsTest)
+#include "trash_jobs_test.moc"
@@ -0,0 +1,164 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "volume_provider.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <utils/command_runner.h>
+
+namespace crystaldock {
+
+VolumeProvider::VolumeProvider() : StatusProvider("Volume") {
+  restartTimer_.setSingleShot(true);
+  connect(&restartTimer_, &QTimer::timeout, this, &VolumeProvider::start);
+  refreshTimer_.setSingleShot(true);
+  refreshTimer_.setInterval(kRefreshDelayMs);
+  connect(&refreshTimer_, &QTimer::timeout, this, &VolumeProvider::refresh);
+}
+
+void VolumeProvider::start() {
+  if (subscription_ != nullptr || !hasSubscribers()) {
+    return;
+  }
+
+  subscription_ = new QProcess(this);
+  connect(subscription_, &QProcess::readyReadStandardOutput,
+          this, &VolumeProvider::onSubscriptionOutput);
+  connect(subscription_, &QProcess::finished, this, &VolumeProvider::onSubscriptionStopped);
+  connect(subscription_, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+    if (error == QProcess::FailedToStart) {
+      onSubscriptionStopped();
+    }
+  });
+  subscription_->start(kCommand, {"subscribe"});
+
+  // Events may have been missed while there was no subscription.
+  refreshTimer_.start();
+}
+
+void VolumeProvider::stop() {
+  restartTimer_.stop();
+  if (subscription_ == nullptr) {
+    return;
+  }
+
+  subscription_->disconnect(this);
+  subscription_->kill();
+  subscription_->deleteLater();
+  subscription_ = nullptr;
+}
+
+void VolumeProvider::onSubscriptionOutput() {
+  // A working subscription resets the backoff.
+  restartDelayMs_ = kMinRestartDelayMs;
+  while (subscription_->canReadLine()) {
+    // e.g. "Event 'change' on sink #47" or "Event 'change' on server #-1".
+    const QString line = subscription_->readLine();
+    if (line.contains(" on sink #") || line.contains(" on server")) {
+      refreshTimer_.start();
+    }
+  }
+}
+
+void VolumeProvider::onSubscriptionStopped() {
+  if (subscription_ == nullptr) {
+    return;
+  }
+
+  subscription_->disconnect(this);
+  subscription_->deleteLater();
+  subscription_ = nullptr;
+  if (hasSubscribers()) {
+    std::cerr << "pactl subscribe has stopped, restarting in " << restartDelayMs_ << " ms"
+              << std::endl;
+    restartTimer_.start(restartDelayMs_);
+    restartDelayMs_ = std::min(2 * restartDelayMs_, kMaxRestartDelayMs);
+  }
+}
+
+void VolumeProvider::refresh() {
+  if (refreshing_) {
+    refreshPending_ = true;
+    return;
+  }
+
+  refreshing_ = true;
+  fetchStarted();
+  query({"get-sink-volume", "@DEFAULT_SINK@"}, [this](bool ok, const QByteArray& output) {
+    VolumeInfo info = info_;
+    if (ok) {
+      static const QRegularExpression kVolumeRegex(R"((\d+)%)");
+      const auto match = kVolumeRegex.match(output);
+      if (match.hasMatch()) {
+        info.volume = match.captured(1).toInt();
+      }
+    }
+    query({"get-sink-mute", "@DEFAULT_SINK@"}, [this, info](bool ok, const QByteArray& output) {
+      VolumeInfo newInfo = info;
+      if (ok) {
+        newInfo.muted = output.toLower().contains("yes");
+      }
+      refreshing_ = false;
+      fetchFinished();
+      setInfo(newInfo);
+
+      if (refreshPending_) {
+        refreshPending_ = false;
+        refresh();
+      }
+    });
+  });
+}
+
+void VolumeProvider::query(const QStringList& args,
+                           std::function<void(bool, const QByteArray&)> onFinished) {
+  CommandOptions options;
+  options.timeoutMs = kQueryTimeoutMs;
+  options.coalesce = true;
+  CommandRunner::self()->run(kCommand, args, this, [onFinished](const CommandResult& result) {
+    onFinished(result.ok(), result.output);
+  }, options);
+}
+
+void VolumeProvider::setInfo(const VolumeInfo& info) {
+  if (info == info_) {
+    return;
+  }
+
+  info_ = info;
+  emit volumeChanged(info_);
+}
+
+void VolumeProvider::setVolume(int volume) {
+  CommandRunner::self()->run(
+      kCommand, {"set-sink-volume", "@DEFAULT_SINK@", QString("%1%").arg(volume)}, this);
+  // Shows the change right away, the sink event will confirm it.
+  setInfo({volume, info_.muted});
+}
+
+void VolumeProvider::toggleMute() {
+  CommandRunner::self()->run(kCommand, {"set-sink-mute", "@DEFAULT_SINK@", "toggle"}, this);
+  setInfo({info_.volume, !info_.muted});
+}
+
+}  // namespace crystaldock
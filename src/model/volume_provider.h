@@ -0,0 +1,96 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_VOLUME_PROVIDER_H_
+#define CRYSTALDOCK_VOLUME_PROVIDER_H_
+
+#include <functional>
+
+#include <QByteArray>
+#include <QProcess>
+#include <QStringList>
+#include <QTimer>
+
+#include "status_provider.h"
+
+namespace crystaldock {
+
+// Volume and mute state of the default PulseAudio/PipeWire sink.
+struct VolumeInfo {
+  int volume = 50;  // in percentage.
+  bool muted = false;
+
+  bool operator==(const VolumeInfo& other) const = default;
+};
+
+// Source of the volume state, shared by all docks.
+//
+// Instead of polling, a single long-lived `pactl subscribe` process reports
+// sink and server events, each burst of which triggers one state refresh.
+// The process is restarted with exponential backoff if it exits.
+class VolumeProvider : public StatusProvider {
+  Q_OBJECT
+
+ public:
+  VolumeProvider();
+
+  const VolumeInfo& info() const { return info_; }
+
+  void setVolume(int volume);
+  void toggleMute();
+
+ signals:
+  void volumeChanged(const VolumeInfo& info);
+
+ protected:
+  // The subscription only runs while there are subscribers.
+  void start() override;
+  void stop() override;
+
+ private:
+  static constexpr char kCommand[] = "pactl";
+  // Coalesces bursts of events e.g. while dragging a volume slider.
+  static constexpr int kRefreshDelayMs = 50;
+  static constexpr int kQueryTimeoutMs = 2000;
+  static constexpr int kMinRestartDelayMs = 1000;
+  static constexpr int kMaxRestartDelayMs = 60000;
+
+  void onSubscriptionOutput();
+  void onSubscriptionStopped();
+
+  // Reads the volume, then the mute state.
+  void refresh();
+  // Runs a pactl query and passes whether it succeeded and its output.
+  void query(const QStringList& args, std::function<void(bool, const QByteArray&)> onFinished);
+  void setInfo(const VolumeInfo& info);
+
+  VolumeInfo info_;
+
+  QProcess* subscription_ = nullptr;
+  QTimer restartTimer_;
+  int restartDelayMs_ = kMinRestartDelayMs;
+
+  QTimer refreshTimer_;
+  bool refreshing_ = false;
+  // Whether another refresh is needed after the current one.
+  bool refreshPending_ = false;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_VOLUME_PROVIDER_H_
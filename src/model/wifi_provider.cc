@@ -0,0 +1,163 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wifi_provider.h"
+
+#include <utility>
+
+#include <utils/command_runner.h>
+
+namespace crystaldock {
+
+const WifiNetwork* WifiStatus::connectedNetwork() const {
+  for (const auto& network : networks) {
+    if (network.inUse) {
+      return &network;
+    }
+  }
+  return nullptr;
+}
+
+WifiProvider::WifiProvider()
+    : StatusProvider("Wi-Fi"), status_(std::make_shared<const WifiStatus>()) {
+  updateTimer_.setSingleShot(true);
+  updateTimer_.setInterval(kUpdateDelayMs);
+  connect(&updateTimer_, &QTimer::timeout, this, [this]() {
+    publish(networkManager_.status());
+  });
+  connect(&networkManager_, &NetworkManagerWifi::initialized,
+          this, &WifiProvider::onNetworkManagerInitialized);
+  connect(&networkManager_, &NetworkManagerWifi::networksChanged,
+          &updateTimer_, qOverload<>(&QTimer::start));
+}
+
+void WifiProvider::start() {
+  if (!status_->scanned) {
+    fetchStarted();
+    networkManager_.init();
+  }
+}
+
+void WifiProvider::onNetworkManagerInitialized(bool available) {
+  fetchFinished();
+  if (!available) {
+    rescanWithNmcli(nullptr);
+  }
+}
+
+void WifiProvider::rescan(std::function<void(bool)> onFinished) {
+  if (!usesNetworkManager()) {
+    rescanWithNmcli(onFinished);
+    return;
+  }
+
+  networkManager_.requestScan([onFinished](bool ok) {
+    if (onFinished) {
+      onFinished(ok);
+    }
+  });
+}
+
+void WifiProvider::rescanWithNmcli(std::function<void(bool)> onFinished) {
+  CommandOptions options;
+  options.timeoutMs = kScanTimeoutMs;
+  options.coalesce = true;
+  fetchStarted();
+  CommandRunner::self()->run(
+      kCommand, {"--terse", "--fields", "SSID,SIGNAL,IN-USE", "dev", "wifi", "list"}, this,
+      [this, onFinished](const CommandResult& result) {
+    fetchFinished();
+    if (!result.ok()) {
+      if (onFinished) {
+        onFinished(false);
+      }
+      return;
+    }
+
+    WifiStatus status;
+    status.scanned = true;
+    for (const QString line : result.output.split('\n')) {
+      QStringList fields = line.split(':');
+      if (fields.size() < 3) continue;
+      const QString& name = fields[0];
+      unsigned int signal = fields[1].toInt();
+      bool inUse = !fields[2].trimmed().isEmpty();
+      if (!name.isEmpty() && signal != 0) {
+        status.networks.push_back({.name = name, .signal = signal, .inUse = inUse});
+      }
+    }
+    publish(std::move(status));
+    if (onFinished) {
+      onFinished(true);
+    }
+  }, options);
+}
+
+void WifiProvider::connectWifi(const QString& network, const QString& password,
+                               std::function<void(bool)> onFinished) {
+  if (usesNetworkManager()) {
+    networkManager_.connectWifi(network, password, onFinished);
+    return;
+  }
+
+  CommandOptions options;
+  options.timeoutMs = kConnectTimeoutMs;
+  options.input = (password + "\n").toUtf8();
+  CommandRunner::self()->run(kCommand, {"dev", "wifi", "connect", network, "--ask"}, this,
+                             [this, network, onFinished](const CommandResult& result) {
+    if (result.ok()) {
+      setInUse(network, true);
+    }
+    onFinished(result.ok());
+  }, options);
+}
+
+void WifiProvider::disconnectWifi(const QString& network, std::function<void(bool)> onFinished) {
+  if (usesNetworkManager()) {
+    networkManager_.disconnectWifi(network, onFinished);
+    return;
+  }
+
+  CommandRunner::self()->run(kCommand, {"connection", "delete", network}, this,
+                             [this, network, onFinished](const CommandResult& result) {
+    if (result.ok()) {
+      setInUse(network, false);
+    }
+    onFinished(result.ok());
+  });
+}
+
+void WifiProvider::setInUse(const QString& network, bool inUse) {
+  WifiStatus status = *status_;
+  for (auto& wifiNetwork : status.networks) {
+    if (wifiNetwork.name == network) {
+      wifiNetwork.inUse = inUse;
+    } else if (inUse) {
+      // Only one network can be in use.
+      wifiNetwork.inUse = false;
+    }
+  }
+  publish(std::move(status));
+}
+
+void WifiProvider::publish(WifiStatus status) {
+  status_ = std::make_shared<const WifiStatus>(std::move(status));
+  emit statusChanged(status_);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,108 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_WIFI_PROVIDER_H_
+#define CRYSTALDOCK_WIFI_PROVIDER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "network_manager_wifi.h"
+#include "status_provider.h"
+
+namespace crystaldock {
+
+struct WifiNetwork {
+  QString name;
+  unsigned int signal = 0;
+  bool inUse = false;
+};
+
+struct WifiStatus {
+  // Whether the networks have been scanned at least once.
+  bool scanned = false;
+  std::vector<WifiNetwork> networks;
+
+  // Returns the network in use, or nullptr if not connected.
+  const WifiNetwork* connectedNetwork() const;
+};
+
+// Source of the Wi-Fi networks, shared by all docks. Integrates with
+// NetworkManager over D-Bus, or with nmcli if the former is not available.
+class WifiProvider : public StatusProvider {
+  Q_OBJECT
+
+ public:
+  WifiProvider();
+
+  std::shared_ptr<const WifiStatus> status() const { return status_; }
+
+  // Whether the networks come from NetworkManager over D-Bus.
+  bool usesNetworkManager() const { return networkManager_.isAvailable(); }
+
+  // `onFinished` is called with whether the scan succeeded. With
+  // NetworkManager, the scan results arrive as access point changes.
+  void rescan(std::function<void(bool)> onFinished = nullptr);
+
+  // `onFinished` is called with whether the command succeeded. With
+  // NetworkManager, that is whether the activation has started.
+  void connectWifi(const QString& network, const QString& password,
+                   std::function<void(bool)> onFinished);
+  void disconnectWifi(const QString& network, std::function<void(bool)> onFinished);
+
+ signals:
+  void statusChanged(const std::shared_ptr<const WifiStatus>& status);
+
+ protected:
+  // Scans the networks on the first subscription.
+  void start() override;
+  void stop() override {}
+
+ private:
+  static constexpr char kCommand[] = "nmcli";
+  static constexpr int kScanTimeoutMs = 30000;
+  // nmcli waits up to 90 seconds for the connection by default.
+  static constexpr int kConnectTimeoutMs = 100000;
+  // Coalesces the access point changes, e.g. after a scan.
+  static constexpr int kUpdateDelayMs = 100;
+
+  void onNetworkManagerInitialized(bool available);
+
+  void rescanWithNmcli(std::function<void(bool)> onFinished);
+
+  // Marks the network as in use or not.
+  void setInUse(const QString& network, bool inUse);
+  void publish(WifiStatus status);
+
+  std::shared_ptr<const WifiStatus> status_;
+
+  NetworkManagerWifi networkManager_;
+  QTimer updateTimer_;
+};
+
+}  // namespace crystaldock
+
+Q_DECLARE_METATYPE(crystaldock::WifiNetwork);
+
+#endif  // CRYSTALDOCK_WIFI_PROVIDER_H_
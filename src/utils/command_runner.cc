@@ -0,0 +1,155 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "command_runner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTimer>
+
+namespace crystaldock {
+
+void CommandRunner::run(const QString& program, const QStringList& args, QObject* context,
+                        Callback callback, const CommandOptions& options) {
+  Caller caller{context, context != nullptr, std::move(callback)};
+  const bool coalesce = options.coalesce && options.input.isEmpty();
+  const QString key = coalesce ? (QStringList{program} + args).join(QChar('\0')) : QString();
+  if (coalesce) {
+    if (auto it = coalescable_.find(key); it != coalescable_.end()) {
+      it->second->callers.push_back(std::move(caller));
+      ++stats_.numCoalesced;
+      return;
+    }
+  }
+
+  auto job = std::make_shared<Job>();
+  job->key = key;
+  job->program = program;
+  job->args = args;
+  job->options = options;
+  job->callers.push_back(std::move(caller));
+  if (coalesce) {
+    coalescable_[key] = job;
+  }
+  queue_.push_back(std::move(job));
+  ++stats_.numQueued;
+  startQueued();
+}
+
+bool CommandRunner::launch(const QString& program, const QStringList& args,
+                           const QProcessEnvironment& environment,
+                           const QString& workingDirectory) {
+  QProcess process;
+  process.setProgram(program);
+  process.setArguments(args);
+  process.setProcessEnvironment(environment);
+  process.setWorkingDirectory(workingDirectory);
+  ++stats_.numLaunched;
+  return process.startDetached();
+}
+
+void CommandRunner::startQueued() {
+  while (numRunning_ < kMaxRunningCommands && !queue_.empty()) {
+    auto job = std::move(queue_.front());
+    queue_.pop_front();
+    --stats_.numQueued;
+    start(job);
+  }
+}
+
+void CommandRunner::start(const std::shared_ptr<Job>& job) {
+  ++numRunning_;
+  stats_.numRunning = numRunning_;
+
+  QProcess* process = new QProcess(this);
+  QTimer* timer = new QTimer(process);
+  auto elapsed = std::make_shared<QElapsedTimer>();
+
+  timer->setSingleShot(true);
+  connect(timer, &QTimer::timeout, process, [job, process]() {
+    job->timedOut = true;
+    // The finished signal follows.
+    process->kill();
+  });
+  if (!job->options.input.isEmpty()) {
+    connect(process, &QProcess::started, process, [job, process]() {
+      process->write(job->options.input);
+      process->closeWriteChannel();
+    });
+  }
+  connect(process, &QProcess::finished, this,
+          [this, job, process, timer, elapsed](int exitCode, QProcess::ExitStatus exitStatus) {
+    timer->stop();
+    CommandResult result;
+    result.started = true;
+    result.timedOut = job->timedOut;
+    result.crashed = exitStatus == QProcess::CrashExit;
+    result.exitCode = exitCode;
+    result.output = process->readAllStandardOutput();
+    result.latencyMs = static_cast<int>(elapsed->elapsed());
+    process->deleteLater();
+    finish(job, std::move(result));
+  });
+  connect(process, &QProcess::errorOccurred, this,
+          [this, job, process, timer, elapsed](QProcess::ProcessError error) {
+    // There is no finished signal in this case.
+    if (error == QProcess::FailedToStart) {
+      timer->stop();
+      CommandResult result;
+      result.latencyMs = static_cast<int>(elapsed->elapsed());
+      process->deleteLater();
+      finish(job, std::move(result));
+    }
+  });
+
+  elapsed->start();
+  timer->start(job->options.timeoutMs);
+  process->start(job->program, job->args);
+}
+
+void CommandRunner::finish(const std::shared_ptr<Job>& job, CommandResult result) {
+  --numRunning_;
+  stats_.numRunning = numRunning_;
+  ++stats_.numRuns;
+  stats_.lastLatencyMs = result.latencyMs;
+  stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, result.latencyMs);
+  stats_.totalLatencyMs += result.latencyMs;
+  if (!result.started) {
+    ++stats_.numFailedToStart;
+  } else if (result.timedOut) {
+    ++stats_.numTimedOut;
+    std::cerr << "Command timed out: " << job->program.toStdString() << " "
+              << job->args.join(' ').toStdString() << std::endl;
+  }
+
+  if (!job->key.isEmpty()) {
+    coalescable_.erase(job->key);
+  }
+  for (const auto& caller : job->callers) {
+    if (caller.callback && (!caller.hasContext || caller.context)) {
+      caller.callback(result);
+    }
+  }
+  startQueued();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,143 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_COMMAND_RUNNER_H_
+#define CRYSTALDOCK_COMMAND_RUNNER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+namespace crystaldock {
+
+struct CommandResult {
+  // False if the command could not be started, e.g. it does not exist.
+  bool started = false;
+  // Whether the command was killed after its timeout.
+  bool timedOut = false;
+  bool crashed = false;
+  int exitCode = -1;
+  QByteArray output;
+  int latencyMs = 0;
+
+  bool ok() const { return started && !timedOut && !crashed && exitCode == 0; }
+};
+
+struct CommandOptions {
+  static constexpr int kDefaultTimeoutMs = 10000;
+
+  int timeoutMs = kDefaultTimeoutMs;
+  // Whether an identical command that is already queued or running can be
+  // shared instead of starting a new one. Only for commands without side
+  // effects, i.e. queries.
+  bool coalesce = false;
+  // Written to the command's standard input.
+  QByteArray input;
+};
+
+struct CommandRunnerStats {
+  int numRuns = 0;
+  int numCoalesced = 0;
+  int numFailedToStart = 0;
+  int numTimedOut = 0;
+  int numLaunched = 0;
+  int numRunning = 0;
+  int numQueued = 0;
+  int lastLatencyMs = 0;
+  int maxLatencyMs = 0;
+  int64_t totalLatencyMs = 0;
+
+  int averageLatencyMs() const {
+    return numRuns > 0 ? static_cast<int>(totalLatencyMs / numRuns) : 0;
+  }
+};
+
+// Runs external commands asynchronously for the whole process.
+//
+// At most kMaxRunningCommands commands run at the same time; the others are
+// queued in order. Every command is killed after its timeout, and the result
+// is passed to the callbacks of all the callers that share it.
+class CommandRunner : public QObject {
+  Q_OBJECT
+
+ public:
+  using Callback = std::function<void(const CommandResult&)>;
+
+  static constexpr int kMaxRunningCommands = 4;
+
+  static CommandRunner* self() {
+    static CommandRunner self;
+    return &self;
+  }
+
+  // Runs the command and calls the callback with the result, unless
+  // `context` is not null and has been destroyed by then.
+  void run(const QString& program, const QStringList& args, QObject* context,
+           Callback callback = nullptr, const CommandOptions& options = {});
+
+  // Starts a command that keeps running on its own, e.g. an application.
+  // Returns false if it could not be started.
+  bool launch(const QString& program, const QStringList& args,
+              const QProcessEnvironment& environment, const QString& workingDirectory);
+
+  const CommandRunnerStats& stats() const { return stats_; }
+
+ private:
+  struct Caller {
+    QPointer<QObject> context;
+    bool hasContext;
+    Callback callback;
+  };
+
+  struct Job {
+    QString key;
+    QString program;
+    QStringList args;
+    CommandOptions options;
+    std::vector<Caller> callers;
+    bool timedOut = false;
+  };
+
+  CommandRunner() = default;
+
+  // Starts queued jobs while under the limit.
+  void startQueued();
+  void start(const std::shared_ptr<Job>& job);
+  void finish(const std::shared_ptr<Job>& job, CommandResult result);
+
+  std::deque<std::shared_ptr<Job>> queue_;
+  // Queued and running jobs that can be coalesced, by command line.
+  std::unordered_map<QString, std::shared_ptr<Job>> coalescable_;
+  int numRunning_ = 0;
+
+  CommandRunnerStats stats_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_COMMAND_RUNNER_H_
@@ -0,0 +1,153 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "command_runner.h"
+
+#include <signal.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QTest>
+
+namespace crystaldock {
+
+class CommandRunnerTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void run_coalesced();
+  void run_queued();
+  void run_timedOut();
+  void run_failedToStart();
+  void run_destroyedContext();
+
+ private:
+  static constexpr int kWaitMs = 5000;
+
+  // Runs the shell command and stores its result in `result` once finished.
+  void runShell(const QString& command, std::shared_ptr<CommandResult> result,
+                const CommandOptions& options = {}, QObject* context = nullptr) {
+    CommandRunner::self()->run("/bin/sh", {"-c", command}, context,
+                               [result](const CommandResult& r) { *result = r; }, options);
+  }
+
+  const CommandRunnerStats& stats() { return CommandRunner::self()->stats(); }
+};
+
+void CommandRunnerTest::run_coalesced() {
+  const int numRuns = stats().numRuns;
+  const int numCoalesced = stats().numCoalesced;
+  CommandOptions options;
+  options.coalesce = true;
+  auto result1 = std::make_shared<CommandResult>();
+  auto result2 = std::make_shared<CommandResult>();
+  runShell("sleep 0.2; echo $$", result1, options);
+  runShell("sleep 0.2; echo $$", result2, options);
+  QCOMPARE(stats().numCoalesced, numCoalesced + 1);
+
+  QTRY_VERIFY_WITH_TIMEOUT(result1->started && result2->started, kWaitMs);
+  QVERIFY(result1->ok());
+  QVERIFY(!result1->output.isEmpty());
+  // The same process.
+  QCOMPARE(result2->output, result1->output);
+  QCOMPARE(stats().numRuns, numRuns + 1);
+
+  // Not coalesced once finished.
+  auto result3 = std::make_shared<CommandResult>();
+  runShell("sleep 0.2; echo $$", result3, options);
+  QTRY_VERIFY_WITH_TIMEOUT(result3->started, kWaitMs);
+  QVERIFY(result3->output != result1->output);
+  QCOMPARE(stats().numCoalesced, numCoalesced + 1);
+}
+
+void CommandRunnerTest::run_queued() {
+  std::vector<std::shared_ptr<CommandResult>> results;
+  for (int i = 0; i <= CommandRunner::kMaxRunningCommands; ++i) {
+    results.push_back(std::make_shared<CommandResult>());
+    runShell("sleep 0.3", results.back());
+  }
+  QCOMPARE(stats().numRunning, CommandRunner::kMaxRunningCommands);
+  QCOMPARE(stats().numQueued, 1);
+
+  // The 5th command starts once one of the others has finished.
+  QTRY_VERIFY_WITH_TIMEOUT(results[0]->started, kWaitMs);
+  QVERIFY(!results.back()->started);
+  QCOMPARE(stats().numQueued, 0);
+  QTRY_VERIFY_WITH_TIMEOUT(results.back()->started, kWaitMs);
+  QVERIFY(results.back()->ok());
+  QVERIFY(results.back()->latencyMs >= 250);
+  QCOMPARE(stats().numRunning, 0);
+}
+
+void CommandRunnerTest::run_timedOut() {
+  const int numTimedOut = stats().numTimedOut;
+  CommandOptions options;
+  options.timeoutMs = 100;
+  auto result = std::make_shared<CommandResult>();
+  runShell("echo $$; exec sleep 10", result, options);
+
+  QTRY_VERIFY_WITH_TIMEOUT(result->started, kWaitMs);
+  QVERIFY(result->timedOut);
+  QVERIFY(!result->ok());
+  QVERIFY(result->latencyMs < 5000);
+  QCOMPARE(stats().numTimedOut, numTimedOut + 1);
+
+  // The process has been killed.
+  const pid_t pid = result->output.trimmed().toInt();
+  QVERIFY(pid > 0);
+  const int error = (kill(pid, 0) == 0) ? 0 : errno;
+  QCOMPARE(error, ESRCH);
+}
+
+void CommandRunnerTest::run_failedToStart() {
+  const int numFailedToStart = stats().numFailedToStart;
+  bool finished = false;
+  CommandResult result;
+  result.started = true;
+  CommandRunner::self()->run("/nonexistent/crystal-dock-command", {}, nullptr,
+                             [&](const CommandResult& r) {
+    result = r;
+    finished = true;
+  });
+
+  QTRY_VERIFY_WITH_TIMEOUT(finished, kWaitMs);
+  QVERIFY(!result.started);
+  QVERIFY(!result.ok());
+  QCOMPARE(stats().numFailedToStart, numFailedToStart + 1);
+}
+
+void CommandRunnerTest::run_destroyedContext() {
+  const int numRuns = stats().numRuns;
+  auto context = std::make_unique<QObject>();
+  auto result = std::make_shared<CommandResult>();
+  runShell("sleep 0.1", result, {}, context.get());
+  context.reset();
+
+  QTRY_COMPARE_WITH_TIMEOUT(stats().numRuns, numRuns + 1, kWaitMs);
+  QVERIFY(!result->started);
+}
+
+}  // namespace crystaldock
+
+QTEST_GUILESS_MAIN(crystaldock::CommandRunnerTest)
+#include "command_runner_test.moc"
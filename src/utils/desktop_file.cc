@@ -18,33 +18,148 @@
 
 #include "desktop_file.h"
 
+#include <QByteArray>
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QLocale>
 #include <QTextStream>
 
 namespace crystaldock {
 
+namespace {
+
+// Returns how well the locale of a localized key matches the current locale:
+// 2 for language and country, 1 for language only, 0 for the unlocalized key
+// and -1 for other locales.
+int localeRank(QByteArrayView locale) {
+  // e.g. "de_DE" and "de".
+  static const QByteArray kFullLocale = QLocale::system().name().toLatin1();
+  static const QByteArray kLanguage = kFullLocale.contains('_')
+      ? kFullLocale.first(kFullLocale.indexOf('_')) : kFullLocale;
+
+  if (locale.isEmpty()) {
+    return 0;
+  }
+  // Ignores the encoding and modifier e.g. "sr_RS@latin".
+  const qsizetype modifier = locale.indexOf('@');
+  if (modifier >= 0) {
+    locale = locale.first(modifier);
+  }
+  if (locale == kFullLocale) {
+    return 2;
+  }
+  if (locale == kLanguage) {
+    return 1;
+  }
+  return -1;
+}
+
+bool isTrue(QByteArrayView value) {
+  return value.size() == 4 && qstrnicmp(value.data(), "true", 4) == 0;
+}
+
+}  // namespace
+
 DesktopFile::DesktopFile(const QString& file) {
   QFile inputFile(file);
   if (inputFile.open(QIODevice::ReadOnly)) {
     appId_ = QFileInfo(file).completeBaseName().toLower();
-    QTextStream input(&inputFile);
-    bool parsing = false;
-    while (!input.atEnd()) {
-      QString line = input.readLine().trimmed();
-      if (!parsing) {
-        if (line == "[Desktop Entry]") {
-          parsing = true;
-        }
-      } else {
-        int index = line.indexOf('=');
-        if (index >= 0 && index < line.length() - 1) {
-          values_[line.left(index)] = line.mid(index + 1);
-        } else if (line.startsWith("[")) {  // start of a new section.
-          break;
-        }
+    const qint64 size = inputFile.size();
+    // Parses straight from the mapped file without copying it.
+    uchar* data = (size > 0) ? inputFile.map(0, size) : nullptr;
+    if (data != nullptr) {
+      parse(QByteArrayView(data, size));
+      inputFile.unmap(data);
+    } else {
+      parse(inputFile.readAll());
+    }
+  }
+}
+
+void DesktopFile::parse(QByteArrayView content) {
+  int nameRank = -1;
+  int genericNameRank = -1;
+  int keywordsRank = -1;
+  bool parsing = false;
+  qsizetype pos = 0;
+  while (pos < content.size()) {
+    qsizetype end = content.indexOf('\n', pos);
+    if (end < 0) {
+      end = content.size();
+    }
+    const QByteArrayView line = content.sliced(pos, end - pos).trimmed();
+    pos = end + 1;
+
+    if (!parsing) {
+      if (line == "[Desktop Entry]") {
+        parsing = true;
       }
+      continue;
+    }
+    if (line.startsWith('[')) {  // start of a new section.
+      break;
+    }
+    if (line.startsWith('#')) {
+      continue;
+    }
+
+    const qsizetype index = line.indexOf('=');
+    if (index <= 0 || index == line.size() - 1) {
+      continue;
+    }
+    QByteArrayView key = line.first(index).trimmed();
+    const QByteArrayView value = line.sliced(index + 1).trimmed();
+
+    int rank = 0;
+    if (key.endsWith(']')) {
+      const qsizetype bracket = key.indexOf('[');
+      if (bracket <= 0) {
+        continue;
+      }
+      rank = localeRank(key.sliced(bracket + 1, key.size() - bracket - 2));
+      key = key.first(bracket);
+    }
+
+    // Localized variants are only used for the names and keywords.
+    if (key == "Name") {
+      if (rank == 0) {
+        unlocalizedName_ = QString::fromUtf8(value);
+      }
+      if (rank >= nameRank) {
+        name_ = QString::fromUtf8(value);
+        nameRank = rank;
+      }
+    } else if (key == "GenericName") {
+      if (rank >= genericNameRank) {
+        genericName_ = QString::fromUtf8(value);
+        genericNameRank = rank;
+      }
+    } else if (key == "Keywords") {
+      if (rank >= keywordsRank) {
+        keywords_ = splitList(QString::fromUtf8(value));
+        keywordsRank = rank;
+      }
+    } else if (rank != 0) {
+      continue;
+    } else if (key == "Type") {
+      type_ = QString::fromUtf8(value);
+    } else if (key == "Exec") {
+      exec_ = QString::fromUtf8(value);
+    } else if (key == "Icon") {
+      icon_ = QString::fromUtf8(value);
+    } else if (key == "Categories") {
+      categories_ = splitList(QString::fromUtf8(value));
+    } else if (key == "StartupWMClass") {
+      wmClass_ = QString::fromUtf8(value);
+    } else if (key == "OnlyShowIn") {
+      onlyShowIn_ = splitList(QString::fromUtf8(value));
+    } else if (key == "NotShowIn") {
+      notShowIn_ = splitList(QString::fromUtf8(value));
+    } else if (key == "NoDisplay") {
+      noDisplay_ = isTrue(value);
+    } else if (key == "Hidden") {
+      hidden_ = isTrue(value);
     }
   }
 }
@@ -53,9 +168,33 @@ bool DesktopFile::write(const QString &file) {
   QFile outputFile(file);
   if (outputFile.open(QIODevice::WriteOnly)) {
     QTextStream output(&outputFile);
+    auto writeValue = [&output](const char* key, const QString& value) {
+      if (!value.isEmpty()) {
+        output << key << "=" << value << "\n";
+      }
+    };
+    auto writeList = [&output](const char* key, const QStringList& values) {
+      if (!values.isEmpty()) {
+        output << key << "=" << values.join(";") << ";\n";
+      }
+    };
+
     output << "[Desktop Entry]\n";
-    for (const auto& key : values_.keys()) {
-      output << key << "=" << values_[key] << "\n";
+    writeValue("Type", type_);
+    writeValue("Name", name_);
+    writeValue("GenericName", genericName_);
+    writeValue("Icon", icon_);
+    writeValue("Exec", exec_);
+    writeValue("StartupWMClass", wmClass_);
+    writeList("Categories", categories_);
+    writeList("Keywords", keywords_);
+    writeList("OnlyShowIn", onlyShowIn_);
+    writeList("NotShowIn", notShowIn_);
+    if (noDisplay_) {
+      output << "NoDisplay=true\n";
+    }
+    if (hidden_) {
+      output << "Hidden=true\n";
     }
 
     return true;
@@ -64,11 +203,11 @@ bool DesktopFile::write(const QString &file) {
 }
 
 bool DesktopFile::showOnDesktop(const QString& desktop) const {
-  if (!onlyShowIn().empty() && !onlyShowIn().contains(desktop)) {
+  if (!onlyShowIn_.empty() && !onlyShowIn_.contains(desktop)) {
     return false;
   }
 
-  if (!notShowIn().empty() && notShowIn().contains(desktop)) {
+  if (!notShowIn_.empty() && notShowIn_.contains(desktop)) {
     return false;
   }
 
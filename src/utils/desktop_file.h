@@ -19,7 +19,7 @@
 #ifndef CRYSTALDOCK_DESKTOP_FILE_H
 #define CRYSTALDOCK_DESKTOP_FILE_H
 
-#include <QMap>
+#include <QByteArrayView>
 #include <QString>
 #include <QStringList>
 
@@ -27,6 +27,9 @@ namespace crystaldock {
 
 // Follows Desktop Entry Specification:
 // https://specifications.freedesktop.org/desktop-entry-spec/latest/index.html
+//
+// Only the keys that we use are extracted. Name, GenericName and Keywords use
+// the variant for the current locale if there is one.
 class DesktopFile {
  public:
   DesktopFile() {}
@@ -35,45 +38,74 @@ class DesktopFile {
 
   QString appId() const { return appId_; }
 
-  QString name() const { return values_["Name"]; }
-  void setName(const QString& name) { values_["Name"] = name; }
+  QString name() const { return name_; }
+  void setName(const QString& name) {
+    name_ = name;
+    unlocalizedName_ = name;
+  }
 
-  QString wmClass() const { return values_["StartupWMClass"]; }
-  void setWMClass(const QString& wmClass) { values_["StartupWMClass"] = wmClass; }
+  // The Name key without a locale, which does not depend on the current locale.
+  QString unlocalizedName() const { return unlocalizedName_; }
 
-  QString genericName() const { return values_["GenericName"]; }
-  void setGenericName(const QString& genericName) { values_["GenericName"] = genericName; }
+  QString wmClass() const { return wmClass_; }
+  void setWMClass(const QString& wmClass) { wmClass_ = wmClass; }
 
-  QString icon() const { return values_["Icon"]; }
-  void setIcon(const QString& icon) { values_["Icon"] = icon; }
+  QString genericName() const { return genericName_; }
+  void setGenericName(const QString& genericName) { genericName_ = genericName; }
 
-  QString exec() const { return values_["Exec"]; }
-  void setExec(const QString& exec) { values_["Exec"] = exec; }
+  QString icon() const { return icon_; }
+  void setIcon(const QString& icon) { icon_ = icon; }
 
-  QString type() const { return values_["Type"]; }
-  void setType(const QString& type) { values_["Type"] = type; }
+  QString exec() const { return exec_; }
+  void setExec(const QString& exec) { exec_ = exec; }
 
-  QStringList categories() const { return values_["Categories"].split(";", Qt::SkipEmptyParts); }
-  void setCategories(const QString& categories) { values_["Categories"] = categories; }
+  QString type() const { return type_; }
+  void setType(const QString& type) { type_ = type; }
 
-  QStringList onlyShowIn() const { return values_["OnlyShowIn"].split(";", Qt::SkipEmptyParts); }
-  void setOnlyShowIn(const QString& desktops) { values_["OnlyShowIn"] = desktops; }
+  const QStringList& categories() const { return categories_; }
+  void setCategories(const QString& categories) { categories_ = splitList(categories); }
 
-  QStringList notShowIn() const { return values_["NotShowIn"].split(";", Qt::SkipEmptyParts); }
-  void setNotShowIn(const QString& desktops) { values_["NotShowIn"] = desktops; }
+  const QStringList& keywords() const { return keywords_; }
+  void setKeywords(const QString& keywords) { keywords_ = splitList(keywords); }
 
-  bool noDisplay() const { return values_["NoDisplay"].toLower() == "true"; }
-  void setNoDisplay(bool value) { values_["NoDisplay"] = value ? "true" : "false"; }
+  const QStringList& onlyShowIn() const { return onlyShowIn_; }
+  void setOnlyShowIn(const QString& desktops) { onlyShowIn_ = splitList(desktops); }
 
-  bool hidden() const { return values_["Hidden"].toLower() == "true"; }
-  void setHidden(bool value) { values_["Hidden"] = value ? "true" : "false"; }
+  const QStringList& notShowIn() const { return notShowIn_; }
+  void setNotShowIn(const QString& desktops) { notShowIn_ = splitList(desktops); }
+
+  bool noDisplay() const { return noDisplay_; }
+  void setNoDisplay(bool value) { noDisplay_ = value; }
+
+  bool hidden() const { return hidden_; }
+  void setHidden(bool value) { hidden_ = value; }
 
   // Should we show this entry on this desktop?
   bool showOnDesktop(const QString& desktop) const;
 
  private:
+  static QStringList splitList(const QString& list) {
+    return list.split(";", Qt::SkipEmptyParts);
+  }
+
+  // Parses the [Desktop Entry] group in a single pass over the file content.
+  void parse(QByteArrayView content);
+
   QString appId_;
-  QMap<QString, QString> values_;
+  QString name_;
+  QString unlocalizedName_;
+  QString genericName_;
+  QString icon_;
+  QString exec_;
+  QString type_;
+  QString wmClass_;
+  // List values are split once when parsed.
+  QStringList categories_;
+  QStringList keywords_;
+  QStringList onlyShowIn_;
+  QStringList notShowIn_;
+  bool noDisplay_ = false;
+  bool hidden_ = false;
 };
 
 }  // namespace crystaldock
@@ -0,0 +1,142 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Desktop file parsing benchmark on a real corpus, compared with a baseline
+// line-by-line QTextStream parser that keeps every key:
+//
+//   desktop_file_benchmark [--iterations=N] [dir (default: /usr/share/applications)]
+
+#include <chrono>
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+
+#include <utils/desktop_file.h>
+
+namespace crystaldock {
+namespace {
+
+// The parser before the single-pass one, as the baseline.
+QMap<QString, QString> parseBaseline(const QString& file) {
+  QMap<QString, QString> values;
+  QFile inputFile(file);
+  if (inputFile.open(QIODevice::ReadOnly)) {
+    QTextStream input(&inputFile);
+    bool parsing = false;
+    while (!input.atEnd()) {
+      QString line = input.readLine().trimmed();
+      if (!parsing) {
+        if (line == "[Desktop Entry]") {
+          parsing = true;
+        }
+      } else {
+        int index = line.indexOf('=');
+        if (index >= 0 && index < line.length() - 1) {
+          values[line.left(index)] = line.mid(index + 1);
+        } else if (line.startsWith("[")) {
+          break;
+        }
+      }
+    }
+  }
+  return values;
+}
+
+// Runs `parse` on all files and returns the elapsed time in seconds.
+template <typename Parse>
+double measure(const QStringList& files, int iterations, Parse parse) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const auto& file : files) {
+      parse(file);
+    }
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int run(const QStringList& args) {
+  QString dir = "/usr/share/applications";
+  int iterations = 20;
+  for (const auto& arg : args) {
+    if (arg.startsWith("--iterations=")) {
+      iterations = arg.mid(arg.indexOf('=') + 1).toInt();
+    } else {
+      dir = arg;
+    }
+  }
+
+  QStringList files;
+  for (const auto& fileName : QDir(dir).entryList({"*.desktop"}, QDir::Files, QDir::Name)) {
+    files.append(dir + "/" + fileName);
+  }
+  if (files.isEmpty() || iterations <= 0) {
+    std::cerr << "No desktop files in " << dir.toStdString() << std::endl;
+    return -1;
+  }
+
+  // Warms up the page cache.
+  measure(files, 1, parseBaseline);
+
+  int numApplications = 0;
+  const double elapsed = measure(files, iterations, [&numApplications](const QString& file) {
+    DesktopFile desktopFile(file);
+    // Touches the fields that the application menu uses.
+    if (desktopFile.type() == "Application" && !desktopFile.categories().isEmpty() &&
+        desktopFile.showOnDesktop("KDE")) {
+      ++numApplications;
+    }
+  });
+  int numBaselineApplications = 0;
+  const double baselineElapsed = measure(
+      files, iterations, [&numBaselineApplications](const QString& file) {
+    const auto values = parseBaseline(file);
+    // The baseline split the lists on every access.
+    const auto onlyShowIn = values["OnlyShowIn"].split(";", Qt::SkipEmptyParts);
+    if (values["Type"] == "Application" &&
+        !values["Categories"].split(";", Qt::SkipEmptyParts).isEmpty() &&
+        (onlyShowIn.isEmpty() || onlyShowIn.contains("KDE")) &&
+        !values["NotShowIn"].split(";", Qt::SkipEmptyParts).contains("KDE")) {
+      ++numBaselineApplications;
+    }
+  });
+
+  const double numParsed = static_cast<double>(files.size()) * iterations;
+  std::cout << "Files: " << files.size() << ", applications: " << numApplications / iterations
+            << " (baseline: " << numBaselineApplications / iterations << ")"
+            << ", iterations: " << iterations << std::endl;
+  std::cout << "DesktopFile: " << elapsed * 1e6 / numParsed << " us/file" << std::endl;
+  std::cout << "Baseline: " << baselineElapsed * 1e6 / numParsed << " us/file" << std::endl;
+  std::cout << "Speed-up: " << (elapsed > 0 ? baselineElapsed / elapsed : 0) << "x"
+            << std::endl;
+  return 0;
+}
+
+}  // namespace
+}  // namespace crystaldock
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+  QStringList args = app.arguments();
+  args.removeFirst();
+  return crystaldock::run(args);
+}
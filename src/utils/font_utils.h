@@ -20,6 +20,7 @@
 #define CRYSTALDOCK_FONT_UTILS_H_
 
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include <QFont>
@@ -27,6 +28,7 @@
 #include <QFontMetrics>
 #include <QRect>
 #include <QString>
+#include <QStringList>
 
 namespace crystaldock {
 
@@ -50,28 +52,42 @@ inline QFont adjustFontSize(int w, int h, const QString& referenceString,
 
 // Gets the list of base font families, i.e. just 'Noto Sans'
 // instead of 'Noto Sans Bold', 'Noto Sans CJK' etc.
-inline std::vector<QString> getBaseFontFamilies() {
+inline std::vector<QString> findBaseFontFamilies(const QStringList& families) {
+  // In sorted order, the families that start with "<family> " come right
+  // after the family or after other such families, so only the chain of
+  // the current family's prefixes has to be checked.
+  std::vector<int> sorted(families.size());
+  std::iota(sorted.begin(), sorted.end(), 0);
+  std::sort(sorted.begin(), sorted.end(), [&families](int i, int j) {
+    return families[i] < families[j];
+  });
+  std::vector<bool> isBaseFont(families.size(), true);
+  std::vector<QString> prefixes;
+  for (int i : sorted) {
+    const QString& family = families[i];
+    while (!prefixes.empty() && !family.startsWith(prefixes.back())) {
+      prefixes.pop_back();
+    }
+    isBaseFont[i] = prefixes.empty();
+    prefixes.push_back(family + ' ');
+  }
+
   std::vector<QString> baseFamilies;
-  QFontDatabase database;
-  const auto families = database.families(QFontDatabase::Latin);
   for (int i = 0; i < families.size(); ++i) {
-    bool isBaseFont = true;
-    const auto family = families.at(i);
-    if (database.isSmoothlyScalable(family)) {
-      for (int j = 0; j < families.size(); ++j) {
-        if (family.startsWith(families[j] + ' ')) {
-          isBaseFont = false;
-          break;
-        }
-      }
-      if (isBaseFont) {
-        baseFamilies.push_back(family);
-      }
+    if (isBaseFont[i] && QFontDatabase::isSmoothlyScalable(families[i])) {
+      baseFamilies.push_back(families[i]);
     }
   }
   return baseFamilies;
 }
 
+// Same as above for the installed Latin font families, computed once.
+inline const std::vector<QString>& getBaseFontFamilies() {
+  static const std::vector<QString> baseFamilies =
+      findBaseFontFamilies(QFontDatabase::families(QFontDatabase::Latin));
+  return baseFamilies;
+}
+
 }  // namespace crystaldock
 
 #endif  // CRYSTALDOCK_FONT_UTILS_H_
@@ -18,8 +18,10 @@
 #ifndef CRYSTALDOCK_ICON_UTILS_H_
 #define CRYSTALDOCK_ICON_UTILS_H_
 
+#include <QHash>
 #include <QIcon>
 #include <QPixmap>
+#include <QString>
 
 namespace crystaldock {
 
@@ -34,6 +36,42 @@ inline QPixmap loadIcon(const QString& iconName, int iconLoadSize) {
   return QPixmap(iconName);
 }
 
+inline QHash<QString, QIcon>& iconCache() {
+  static QHash<QString, QIcon> cache;
+  return cache;
+}
+
+// Returns the icon with the given name in the icon theme, or from the file if
+// the name is a path. Icons are cached and shared by all docks, and their
+// pixmaps are only loaded when painted. Icons that are not found are not
+// cached, as they might be installed later. Must be called from the GUI thread.
+inline QIcon loadCachedIcon(const QString& iconName) {
+  static QString themeName;
+  auto& cache = iconCache();
+  if (QIcon::themeName() != themeName) {
+    cache.clear();
+    themeName = QIcon::themeName();
+  }
+
+  auto it = cache.constFind(iconName);
+  if (it != cache.constEnd()) {
+    return *it;
+  }
+  QIcon icon = QIcon::fromTheme(iconName);
+  if (icon.isNull() && iconName.startsWith('/')) {
+    icon = QIcon(iconName);
+  }
+  if (!icon.isNull()) {
+    cache.insert(iconName, icon);
+  }
+  return icon;
+}
+
+// E.g. after applications have been installed or removed.
+inline void clearIconCache() {
+  iconCache().clear();
+}
+
 }  // namespace crystaldock
 
 #endif  // CRYSTALDOCK_ICON_UTILS_H_
@@ -27,13 +27,19 @@
 namespace crystaldock {
 
 // A work-around for sub-menu alignment issue on Wayland by adding
-// empty items to the sub-menu.
+// empty items to the sub-menu, or removing the surplus ones at the end
+// (e.g. after an entry has been inserted before them).
 inline void patchMenu(unsigned int totalNumItems, int iconSize, QMenu* menu) {
+  auto actions = menu->actions();
+  while (actions.size() > totalNumItems && actions.back()->text().isEmpty() &&
+         !actions.back()->isSeparator()) {
+    delete actions.takeLast();
+  }
+
   QPixmap pix(iconSize, iconSize);
   pix.fill(QColorConstants::Transparent);
   const QIcon icon(pix);
-  const auto numItemsToAdd = totalNumItems - menu->actions().size();
-  for (unsigned int i = 0; i < numItemsToAdd; ++i) {
+  for (auto i = actions.size(); i < totalNumItems; ++i) {
     menu->addAction(icon, "");
   }
 }
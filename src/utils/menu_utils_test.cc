@@ -0,0 +1,89 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "menu_utils.h"
+
+#include <QMenu>
+#include <QStringList>
+#include <QTest>
+
+namespace crystaldock {
+
+class MenuUtilsTest: public QObject {
+  Q_OBJECT
+
+ private slots:
+  void patchMenu_padded();
+  void patchMenu_insertBeforePadding();
+
+ private:
+  static constexpr int kIconSize = 16;
+
+  QStringList texts(const QMenu& menu) {
+    QStringList result;
+    for (const auto* action : menu.actions()) {
+      result.append(action->text());
+    }
+    return result;
+  }
+};
+
+void MenuUtilsTest::patchMenu_padded() {
+  QMenu menu;
+  menu.addAction("Dolphin");
+  menu.addAction("Konsole");
+  patchMenu(4, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole", "", ""}));
+
+  // Already padded.
+  patchMenu(4, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole", "", ""}));
+
+  // No padding needed.
+  patchMenu(1, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole"}));
+}
+
+void MenuUtilsTest::patchMenu_insertBeforePadding() {
+  QMenu menu;
+  menu.addAction("Dolphin");
+  menu.addAction("Konsole");
+  patchMenu(4, kIconSize, &menu);
+
+  // Entries are inserted before the padding items, as in ApplicationMenu::applyDelta().
+  menu.insertAction(menu.actions()[2], new QAction("Kate", &menu));
+  patchMenu(4, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole", "Kate", ""}));
+
+  menu.insertAction(menu.actions()[3], new QAction("Okular", &menu));
+  menu.insertAction(menu.actions()[4], new QAction("Spectacle", &menu));
+  patchMenu(4, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole", "Kate", "Okular", "Spectacle"}));
+
+  // Pads again once entries are removed.
+  delete menu.actions()[4];
+  delete menu.actions()[3];
+  delete menu.actions()[2];
+  patchMenu(4, kIconSize, &menu);
+  QCOMPARE(texts(menu), QStringList({"Dolphin", "Konsole", "", ""}));
+}
+
+}  // namespace crystaldock
+
+QTEST_MAIN(crystaldock::MenuUtilsTest)
+#include "menu_utils_test.moc"
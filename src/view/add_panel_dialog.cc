@@ -21,9 +21,9 @@
 
 #include <QGuiApplication>
 
-#include "battery_indicator.h"
 #include <desktop/desktop_env.h>
 #include <display/window_system.h>
+#include <model/battery_provider.h>
 
 namespace crystaldock {
 
@@ -105,7 +105,7 @@ void AddPanelDialog::setMode(Mode mode) {
   ui->showWifiManager->setChecked(mode == Mode::Welcome);
   ui->showVolumeControl->setChecked(mode == Mode::Welcome);
   ui->showBatteryIndicator->setChecked(
-      mode == Mode::Welcome && !BatteryIndicator::getBatteryDevice().isEmpty());
+      mode == Mode::Welcome && !BatteryProvider::findBattery().isEmpty());
   ui->showKeyboardLayout->setChecked(mode == Mode::Welcome);
   ui->showVersionChecker->setChecked(mode == Mode::Welcome);
   ui->showClock->setChecked(mode == Mode::Welcome);
@@ -21,11 +21,14 @@
 #include <algorithm>
 
 #include <QApplication>
+#include <QCollator>
 #include <QDrag>
 #include <QFont>
 #include <QMimeData>
+#include <QPromise>
 #include <QSettings>
 #include <QStringBuilder>
+#include <QThreadPool>
 #include <QTimer>
 #include <QUrl>
 
@@ -34,6 +37,7 @@
 #include "dock_panel.h"
 #include "program.h"
 #include <utils/draw_utils.h>
+#include <utils/icon_utils.h>
 #include <utils/menu_utils.h>
 
 namespace crystaldock {
@@ -73,8 +77,10 @@ ApplicationMenu::ApplicationMenu(
           [this]() {
             parent_->setShowingPopup(false);
           });
-  connect(model_, SIGNAL(applicationMenuConfigChanged()),
-          this, SLOT(reloadMenu()));
+  connect(model_, &MultiDockModel::applicationMenuEntriesChanged,
+          this, &ApplicationMenu::applyDelta);
+  connect(&searchWatcher_, &QFutureWatcher<SearchResult>::finished,
+          this, &ApplicationMenu::onSearchFinished);
 }
 
 void ApplicationMenu::draw(QPainter* painter) const {
@@ -122,11 +128,72 @@ void ApplicationMenu::mousePressEvent(QMouseEvent *e) {
 }
 
 void ApplicationMenu::reloadMenu() {
+  searchWatcher_.future().cancel();
+  searchActions_.clear();
   menu_.clear();
+  categoryMenus_.clear();
+  populatedMenus_.clear();
   searchMenu_ = nullptr;
   buildMenu();
 }
 
+void ApplicationMenu::applyDelta(const ApplicationMenuDelta& delta) {
+  // Adding or removing a whole category changes the layout of the menu, so it
+  // is rebuilt in that case.
+  for (const auto& categoryDelta : delta.categories) {
+    if (categoryDelta.category == ApplicationMenuConfig::kUncategorized) {
+      continue;
+    }
+    const auto& categories = model_->applicationMenuCategories();
+    auto category = std::find_if(categories.begin(), categories.end(),
+                                 [&categoryDelta](const Category& category) {
+                                   return category.name == categoryDelta.category;
+                                 });
+    const bool hasEntries = category != categories.end() && !category->entries.empty();
+    if (hasEntries != categoryMenus_.contains(categoryDelta.category)) {
+      reloadMenu();
+      return;
+    }
+  }
+
+  // The same order as the sorted categories.
+  QCollator collator;
+  collator.setCaseSensitivity(Qt::CaseInsensitive);
+  for (const auto& categoryDelta : delta.categories) {
+    // Sub-menus that have not been shown yet will be populated with the new entries.
+    QMenu* menu = categoryMenus_.value(categoryDelta.category);
+    if (menu == nullptr || !populatedMenus_.contains(menu)) {
+      continue;
+    }
+
+    for (const auto& entry : categoryDelta.removed) {
+      for (auto* action : menu->actions()) {
+        if (action->data().toString() == entry.desktopFile && action->text() == entry.name) {
+          delete action;
+          break;
+        }
+      }
+    }
+
+    for (const auto& entry : categoryDelta.added) {
+      if (entry.hidden) {
+        continue;
+      }
+      // Entries are sorted by name, followed by the empty padding items.
+      QAction* before = nullptr;
+      for (auto* action : menu->actions()) {
+        if (action->text().isEmpty() || collator.compare(action->text(), entry.name) > 0) {
+          before = action;
+          break;
+        }
+      }
+      menu->insertAction(before, createAction(entry, menu));
+    }
+
+    patchCategoryMenu(menu);
+  }
+}
+
 void ApplicationMenu::searchApps(const QString& searchText_) {
   if (searchMenu_ == nullptr) {
     return;
@@ -138,17 +205,85 @@ void ApplicationMenu::searchApps(const QString& searchText_) {
     return;
   }
 
-  const auto actions = searchMenu_->actions();
-  for (int i = 1; i < actions.size(); ++i) {
-    searchMenu_->removeAction(actions[i]);
+  searchWatcher_.future().cancel();
+  auto searchIndex = model_->applicationSearchIndex();
+  if (searchIndex != searchIndex_) {
+    // The previous matches refer to the old index.
+    searchIndex_ = searchIndex;
+    searchState_ = {};
   }
 
+  auto promise = std::make_shared<QPromise<SearchResult>>();
+  searchWatcher_.setFuture(promise->future());
+  promise->start();
   // We need to limit max number of results to avoid the sub-menu being pushed up too much.
-  for (const auto& entry : model_->searchApplications(text, maxNumResults_)) {
-    addEntry(entry, searchMenu_);
+  QThreadPool::globalInstance()->start(
+      [promise, searchIndex, text, maxNumResults = maxNumResults_, state = searchState_] {
+        if (!promise->isCanceled()) {
+          SearchResult result{{}, state};
+          result.entries = searchIndex->search(text, maxNumResults, &result.state);
+          promise->addResult(std::move(result));
+        }
+        promise->finish();
+      });
+}
+
+void ApplicationMenu::onSearchFinished() {
+  const auto future = searchWatcher_.future();
+  if (future.isCanceled() || future.resultCount() == 0) {
+    return;
+  }
+
+  const auto result = future.result();
+  searchState_ = result.state;
+  setSearchResults(result.entries);
+}
+
+void ApplicationMenu::setSearchResults(const std::vector<ApplicationEntry>& entries) {
+  QHash<QString, QAction*> rows;
+  for (auto* action : searchActions_) {
+    rows.insert(action->data().toString(), action);
+  }
+  std::vector<QAction*> newRows;
+  for (const auto& entry : entries) {
+    QAction* action = rows.take(entry.desktopFile);
+    if (action == nullptr || action->text() != entry.name) {
+      delete action;
+      action = createAction(entry, searchMenu_);
+    }
+    newRows.push_back(action);
+  }
+  qDeleteAll(rows);
+
+  // The rows are right after the search box.
+  for (size_t i = 0; i < newRows.size(); ++i) {
+    const auto actions = searchMenu_->actions();
+    QAction* current = (static_cast<qsizetype>(i) + 1 < actions.size()) ? actions[i + 1] : nullptr;
+    if (current != newRows[i]) {
+      searchMenu_->insertAction(current, newRows[i]);
+    }
+  }
+  searchActions_ = std::move(newRows);
+  padSearchMenu();
+}
+
+void ApplicationMenu::padSearchMenu() {
+  const auto actions = searchMenu_->actions();
+  std::vector<QAction*> paddingItems;
+  for (qsizetype i = 1; i < actions.size(); ++i) {
+    if (std::find(searchActions_.begin(), searchActions_.end(), actions[i]) ==
+        searchActions_.end()) {
+      paddingItems.push_back(actions[i]);
+    }
+  }
+
+  const size_t numPaddingItems = (parent_->isBottom() && maxNumResults_ > searchActions_.size())
+      ? maxNumResults_ - searchActions_.size() : 0;
+  while (paddingItems.size() > numPaddingItems) {
+    delete paddingItems.back();
+    paddingItems.pop_back();
   }
   if (parent_->isBottom()) {
-    // Work-around for sub-menu alignment issue on Wayland.
     patchMenu(maxNumResults_ + 1, model_->applicationMenuIconSize(), searchMenu_);
   }
 }
@@ -231,14 +366,7 @@ void ApplicationMenu::buildMenu() {
   addToMenu(model_->applicationMenuCategories());
   menu_.addSeparator();
   addToMenu(model_->applicationMenuSystemCategories());
-  const auto numSubMenus = menu_.actions().size();
-  for (int i = 0; i < numSubMenus; ++i) {
-    QMenu* menu = menu_.actions()[i]->menu();
-    if (menu != nullptr && parent_->isBottom()) {
-      // Work-around for sub-menu alignment issue on Wayland.
-      patchMenu(numSubMenus - i, model_->applicationMenuIconSize(), menu);
-    }
-  }
+  patchCategoryMenu(searchMenu_);
   maxNumResults_ = menu_.actions().size() - 2;
 }
 
@@ -270,10 +398,38 @@ void ApplicationMenu::addToMenu(const std::vector<Category>& categories) {
     menu->setStyle(&style_);
     menu->setFont(font_);
     menu->installEventFilter(this);
-    for (const auto& entry : category.entries) {
+    categoryMenus_[category.name] = menu;
+    const QString categoryName = category.name;
+    connect(menu, &QMenu::aboutToShow, this, [this, categoryName, menu] {
+      populateCategoryMenu(categoryName, menu);
+    });
+  }
+}
+
+void ApplicationMenu::populateCategoryMenu(const QString& categoryName, QMenu* menu) {
+  if (populatedMenus_.contains(menu)) {
+    return;
+  }
+
+  populatedMenus_.insert(menu);
+  if (const auto* category = findCategory(categoryName)) {
+    for (const auto& entry : category->entries) {
       addEntry(entry, menu);
     }
   }
+  patchCategoryMenu(menu);
+}
+
+const Category* ApplicationMenu::findCategory(const QString& categoryName) const {
+  for (const auto* categories : {&model_->applicationMenuCategories(),
+                                 &model_->applicationMenuSystemCategories()}) {
+    for (const auto& category : *categories) {
+      if (category.name == categoryName) {
+        return &category;
+      }
+    }
+  }
+  return nullptr;
 }
 
 void ApplicationMenu::addEntry(const ApplicationEntry &entry, QMenu *menu) {
@@ -281,28 +437,41 @@ void ApplicationMenu::addEntry(const ApplicationEntry &entry, QMenu *menu) {
     return;
   }
 
-  QAction* action = menu->addAction(loadIcon(entry.icon), entry.name, this,
-                  [entry]() {
-                    Program::launch(entry.command);
-                  });
+  menu->addAction(createAction(entry, menu));
+}
+
+QAction* ApplicationMenu::createAction(const ApplicationEntry& entry, QMenu* menu) {
+  QAction* action = new QAction(loadIcon(entry.icon), entry.name, menu);
+  connect(action, &QAction::triggered, this,
+          [entry]() {
+            Program::launch(entry.command);
+          });
   action->setData(entry.desktopFile);
+  return action;
+}
+
+void ApplicationMenu::patchCategoryMenu(QMenu* menu) {
+  if (!parent_->isBottom()) {
+    return;
+  }
+
+  const auto actions = menu_.actions();
+  const int numSubMenus = actions.size();
+  const int index = actions.indexOf(menu->menuAction());
+  if (index >= 0) {
+    patchMenu(numSubMenus - index, model_->applicationMenuIconSize(), menu);
+  }
 }
 
 void ApplicationMenu::resetSearchMenu() {
   searchText_->clear();
   searchText_->setFocus();
-  const auto actions = searchMenu_->actions();
-  for (int i = 1; i < actions.size(); ++i) {
-    searchMenu_->removeAction(actions[i]);
-  }
-  if (parent_->isBottom()) {
-    // Work-around for sub-menu alignment issue on Wayland.
-    patchMenu(maxNumResults_ + 1, model_->applicationMenuIconSize(), searchMenu_);
-  }
+  searchWatcher_.future().cancel();
+  setSearchResults({});
 }
 
 QIcon ApplicationMenu::loadIcon(const QString &icon) {
-  return QIcon::fromTheme(icon);
+  return loadCachedIcon(icon);
 }
 
 void ApplicationMenu::createContextMenu() {
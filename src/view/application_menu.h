@@ -21,8 +21,15 @@
 
 #include "icon_based_dock_item.h"
 
+#include <memory>
+#include <vector>
+
+#include <QAction>
 #include <QEvent>
 #include <QFont>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
 #include <QLineEdit>
 #include <QMenu>
 #include <QMouseEvent>
@@ -32,6 +39,7 @@
 #include <QString>
 
 #include <model/application_menu_config.h>
+#include <model/application_search_index.h>
 
 namespace crystaldock {
 
@@ -78,6 +86,9 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
  public slots:
   void reloadMenu();
 
+  // Updates the affected category menus in place.
+  void applyDelta(const ApplicationMenuDelta& delta);
+
   void searchApps(const QString& searchText);
 
  protected:
@@ -85,6 +96,11 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
   bool eventFilter(QObject* object, QEvent* event) override;
 
  private:
+  struct SearchResult {
+    std::vector<ApplicationEntry> entries;
+    ApplicationSearchIndex::SearchState state;
+  };
+
   QString getStyleSheet();
 
   QIcon loadIcon(const QString& icon);
@@ -93,15 +109,38 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
   void buildMenu();
   void addSearchMenu();
   void addToMenu(const std::vector<Category>& categories);
+
+  // Adds the entries to a category sub-menu the first time it is shown.
+  void populateCategoryMenu(const QString& categoryName, QMenu* menu);
+  const Category* findCategory(const QString& categoryName) const;
+
   void addEntry(const ApplicationEntry& entry, QMenu* menu);
+  QAction* createAction(const ApplicationEntry& entry, QMenu* menu);
+
+  // Work-around for sub-menu alignment issue on Wayland.
+  void patchCategoryMenu(QMenu* menu);
 
   void resetSearchMenu();
 
+  void onSearchFinished();
+
+  // Updates the search result rows in place: rows still in the results are
+  // kept (and moved if needed), so only new rows load their icons.
+  void setSearchResults(const std::vector<ApplicationEntry>& entries);
+
+  // Work-around for sub-menu alignment issue on Wayland, with the padding
+  // items after the result rows.
+  void padSearchMenu();
+
   void createContextMenu();
 
   // The cascading popup menu that contains all application entries.
   QMenu menu_;
   bool showingMenu_;
+  // Sub-menus by category name.
+  QHash<QString, QMenu*> categoryMenus_;
+  // Sub-menus that have been populated.
+  QSet<QMenu*> populatedMenus_;
 
   ApplicationMenuStyle style_;
   QFont font_;
@@ -116,6 +155,11 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
   QMenu* searchMenu_;
   QLineEdit* searchText_;
   unsigned int maxNumResults_;
+  // Searches run on the thread pool, only the latest one is not cancelled.
+  QFutureWatcher<SearchResult> searchWatcher_;
+  std::shared_ptr<const ApplicationSearchIndex> searchIndex_;
+  ApplicationSearchIndex::SearchState searchState_;
+  std::vector<QAction*> searchActions_;
 
   // Context (right-click) menu.
   QMenu contextMenu_;
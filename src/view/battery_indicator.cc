@@ -18,28 +18,22 @@
 
 #include "battery_indicator.h"
 
-#include <QMessageBox>
-
 #include "dock_panel.h"
-
-#include <utils/command_utils.h>
+#include <model/status_hub.h>
 
 namespace crystaldock {
 
 BatteryIndicator::BatteryIndicator(DockPanel* parent, MultiDockModel* model,
                                    Qt::Orientation orientation, int minSize, int maxSize)
     : IconBasedDockItem(parent, model, kLabel, orientation, kIcon,
-                        minSize, maxSize),
-    updateTimer_(new QTimer(this)),
-    process_(nullptr) {
+                        minSize, maxSize) {
   createMenu();
 
-  // Sets up update timer.
-  QTimer::singleShot(500, this, [this]() {
-    connect(updateTimer_, &QTimer::timeout, this, &BatteryIndicator::refreshBatteryInfo);
-    updateTimer_->start(kUpdateInterval);
-    batteryDevice_ = getBatteryDevice();
-  });
+  // The battery state is shared by all docks.
+  connect(StatusHub::self()->battery(), &BatteryProvider::batteryChanged,
+          this, &BatteryIndicator::onBatteryChanged);
+  StatusHub::self()->battery()->subscribe();
+  onBatteryChanged(StatusHub::self()->battery()->info());
 
   connect(&contextMenu_, &QMenu::aboutToHide, this,
           [this]() {
@@ -48,86 +42,25 @@ BatteryIndicator::BatteryIndicator(DockPanel* parent, MultiDockModel* model,
 }
 
 BatteryIndicator::~BatteryIndicator() {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    process_->kill();
-    process_->waitForFinished(1000);
-  }
+  StatusHub::self()->battery()->unsubscribe();
 }
 
 void BatteryIndicator::mousePressEvent(QMouseEvent* e) {
-  if (e->button() == Qt::LeftButton) {
-    if (commandExists({kCommand}).isEmpty()) {
-      QMessageBox::warning(parent_, "Command not found",
-                           QString("Command '") + kCommand + "' not found. This is required by the "
-                               + kLabel + " component.");
-      return;
-    }
-  } else if (e->button() == Qt::RightButton) {
+  if (e->button() == Qt::RightButton) {
     showPopupMenu(&contextMenu_);
   }
 }
 
 QString BatteryIndicator::getLabel() const {
-  return batteryDevice_.isNull()
-      ? kLabel
-      : batteryDevice_.isEmpty()
-          ? "Battery: Not found"
-          : "Battery: " + QString::number(batteryLevel_) + "%"
-              + (isCharging_ ? " (charging)" : "");
-}
-
-void BatteryIndicator::refreshBatteryInfo() {
-  // Prevent concurrent processes
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  if (batteryDevice_.isEmpty()) {
-    return;
-  }
-
-  process_ = new QProcess(parent_);
-  connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              bool isCharging = false;
-              int batteryLevel = 0;
-              QRegularExpression chargingRe(R"(state:(\s+)charging)");
-              QRegularExpression percentageRe(R"(percentage:(\s+)(\d+.?\d*)(\s*)%)");
-              for (const QByteArray& line : process_->readAllStandardOutput().split('\n')) {
-                if (chargingRe.match(line).hasMatch()) {
-                  isCharging = true;
-                }
-                auto match = percentageRe.match(line);
-                if (match.hasMatch()) {
-                  batteryLevel = static_cast<int>(std::round(match.captured(2).toFloat()));
-                }
-              }
-              if (isCharging_ != isCharging || batteryLevel_ != batteryLevel) {
-                isCharging_ = isCharging;
-                batteryLevel_ = batteryLevel;
-                updateUi();
-              }
-            }
-            process_->deleteLater();
-            process_ = nullptr;
-          });
-
-  process_->start(kCommand, QStringList() << "-i" << batteryDevice_);
+  return !battery_.present
+      ? "Battery: Not found"
+      : "Battery: " + QString::number(battery_.level) + "%"
+          + (battery_.charging ? " (charging)" : "");
 }
 
-QString BatteryIndicator::getBatteryDevice() {
-  QProcess process;
-  process.start(kCommand, QStringList() << "--enumerate");
-  process.waitForFinished(1000 /*msecs*/);
-  for (const QByteArray& device : process.readAllStandardOutput().split('\n')) {
-    if (device.toLower().contains("battery")) {
-      return device;
-    }
-  }
-  // Returns an empty string instead of null string to specify that
-  // the battery device was not found.
-  return QString("");
+void BatteryIndicator::onBatteryChanged(const BatteryInfo& info) {
+  battery_ = info;
+  updateUi();
 }
 
 void BatteryIndicator::createMenu() {
@@ -138,10 +71,10 @@ void BatteryIndicator::createMenu() {
 
 void BatteryIndicator::updateUi() {
   QString iconName = kIcon;
-  if (!batteryDevice_.isEmpty() && batteryLevel_ > 0 && !isCharging_) {
-    if (batteryLevel_ < 20) {
+  if (battery_.present && battery_.level > 0 && !battery_.charging) {
+    if (battery_.level < 20) {
       iconName = "battery-low";
-    } else if (batteryLevel_ < 40) {
+    } else if (battery_.level < 40) {
       iconName = "battery-caution";
     }
   }
@@ -22,12 +22,12 @@
 #include "icon_based_dock_item.h"
 
 #include <QMouseEvent>
-#include <QProcess>
-#include <QTimer>
+
+#include <model/battery_provider.h>
 
 namespace crystaldock {
 
-// A battery indicator that integrates with upower.
+// A battery indicator that reads the battery state from sysfs.
 class BatteryIndicator : public QObject, public IconBasedDockItem {
   Q_OBJECT
 
@@ -40,31 +40,19 @@ class BatteryIndicator : public QObject, public IconBasedDockItem {
   QString getLabel() const override;
   bool beforeTask(const QString& program) override { return false; }
 
-  static QString getBatteryDevice();
-
  public slots:
-  void refreshBatteryInfo();
+  void onBatteryChanged(const BatteryInfo& info);
 
  private:
-  static constexpr char kCommand[] = "upower";
   static constexpr char kLabel[] = "Battery Indicator";
   static constexpr char kIcon[] = "battery";
-  static constexpr int kUpdateInterval = 1000;  // 1 second.
 
   // Creates the context menu.
   void createMenu();
 
   void updateUi();
 
-  QString batteryDevice_;
-  int batteryLevel_ = 0;  // in percentage.
-  bool isCharging_ = false;
-
-  // Update timer.
-  QTimer* updateTimer_;
-
-  // upower process.
-  QProcess* process_ = nullptr;
+  BatteryInfo battery_;
 
   // Right-click context menu.
   QMenu contextMenu_;
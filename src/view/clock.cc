@@ -18,6 +18,8 @@
 
 #include "clock.h"
 
+#include <algorithm>
+
 #include <QColor>
 #include <QDate>
 #include <QFont>
@@ -43,9 +45,11 @@ Clock::Clock(DockPanel* parent, MultiDockModel* model,
   createMenu();
   loadConfig();
 
-  QTimer* timer = new QTimer(this);
-  connect(timer, SIGNAL(timeout()), this, SLOT(updateTime()));
-  timer->start(1000);  // update the time every second.
+  updateTimer_.setSingleShot(true);
+  // Coarse timers can fire early by up to 5%.
+  updateTimer_.setTimerType(Qt::PreciseTimer);
+  connect(&updateTimer_, &QTimer::timeout, this, &Clock::updateTime);
+  scheduleUpdate();
 
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
@@ -55,18 +59,20 @@ Clock::Clock(DockPanel* parent, MultiDockModel* model,
 
 void Clock::draw(QPainter *painter) const {
   const QString timeFormat = model_->use24HourClock() ? "hh:mm" : "hh:mm AP";
-  const QString time = QTime::currentTime().toString(timeFormat);
-  // The reference time used to calculate the font size.
-  const QString referenceTime = QTime(8, 8).toString(timeFormat);
+  const int minute = currentMinute();
+  if (minute != timeMinute_ || timeFormat != timeFormat_) {
+    time_ = QTime(minute / 60, minute % 60).toString(timeFormat);
+    timeMinute_ = minute;
+    timeFormat_ = timeFormat;
+  }
+  const QString& time = time_;
 
   const int margin = parent_->isHorizontal() ? getHeight() * 0.1 : 0;
   const auto x = left_ + margin;
   const auto y = top_;
   const auto w = getWidth() - margin;
   const auto h = getHeight();
-  painter->setFont(adjustFontSize(w, h, referenceTime,
-                                  model_->clockFontScaleFactor(),
-                                  model_->clockFontFamily()));
+  painter->setFont(getFont(w, h, timeFormat));
   painter->setRenderHint(QPainter::TextAntialiasing);
   if (size_ > minSize_) {
     drawBorderedText(x, y , w, h, Qt::AlignCenter, time,
@@ -93,7 +99,49 @@ QString Clock::getLabel() const {
 }
 
 void Clock::updateTime() {
-  parent_->update();
+  if (currentMinute() != timeMinute_) {
+    parent_->update(getUpdateRect());
+  }
+  scheduleUpdate();
+}
+
+void Clock::scheduleUpdate() {
+  const int msSinceMinute = QTime::currentTime().msecsSinceStartOfDay() % kMsPerMinute;
+  updateTimer_.start(std::min(kMsPerMinute - msSinceMinute + kUpdateSlackMs,
+                              kMaxUpdateIntervalMs));
+}
+
+int Clock::currentMinute() const {
+  return QTime::currentTime().msecsSinceStartOfDay() / kMsPerMinute;
+}
+
+QRect Clock::getUpdateRect() const {
+  // The whole cross section of the dock, as the 3D style mirrors the items
+  // at the bottom and the item's position changes when zooming.
+  return parent_->isHorizontal()
+      ? QRect(left_, 0, getMaxWidth(), parent_->height())
+      : QRect(0, top_, parent_->width(), getMaxHeight());
+}
+
+const QFont& Clock::getFont(int w, int h, const QString& timeFormat) const {
+  const float scaleFactor = model_->clockFontScaleFactor();
+  const QString fontFamily = model_->clockFontFamily();
+  if (scaleFactor != fontScaleFactor_ || fontFamily != fontFamily_
+      || timeFormat != fontTimeFormat_) {
+    fonts_.clear();
+    fontScaleFactor_ = scaleFactor;
+    fontFamily_ = fontFamily;
+    fontTimeFormat_ = timeFormat;
+  }
+
+  const qint64 key = (static_cast<qint64>(w) << 32) | static_cast<quint32>(h);
+  auto it = fonts_.find(key);
+  if (it == fonts_.end()) {
+    // The reference time used to calculate the font size.
+    const QString referenceTime = QTime(8, 8).toString(timeFormat);
+    it = fonts_.emplace(key, adjustFontSize(w, h, referenceTime, scaleFactor, fontFamily)).first;
+  }
+  return it->second;
 }
 
 void Clock::setFontScaleFactor(float fontScaleFactor) {
@@ -130,16 +178,10 @@ void Clock::createMenu() {
       });
   use24HourClockAction_->setCheckable(true);
 
-  QMenu* fontFamily = menu_.addMenu(QString("Font Family"));
-  for (const auto& family : getBaseFontFamilies()) {
-    auto fontFamilyAction = fontFamily->addAction(family, this, [this, family]{
-      model_->setClockFontFamily(family);
-      model_->saveAppearanceConfig(true /* repaintOnly */);
-    });
-    fontFamilyAction->setCheckable(true);
-    fontFamilyAction->setActionGroup(&fontFamilyGroup_);
-    fontFamilyAction->setChecked(family == model_->clockFontFamily());
-  }
+  // The font families are only listed when the submenu is first opened, as
+  // the clocks are recreated on every reload.
+  fontFamilyMenu_ = menu_.addMenu(QString("Font Family"));
+  connect(fontFamilyMenu_, &QMenu::aboutToShow, this, &Clock::createFontFamilyMenu);
 
   QMenu* fontSize = menu_.addMenu(QString("Font Size"));
   largeFontAction_ = fontSize->addAction(QString("Large Font"),
@@ -159,9 +201,30 @@ void Clock::createMenu() {
   parent_->addPanelSettings(&menu_);
 }
 
+void Clock::createFontFamilyMenu() {
+  if (!fontFamilyMenu_->isEmpty()) {
+    return;
+  }
+
+  for (const auto& family : getBaseFontFamilies()) {
+    auto fontFamilyAction = fontFamilyMenu_->addAction(family, this, [this, family]{
+      model_->setClockFontFamily(family);
+      model_->saveAppearanceConfig(true /* repaintOnly */);
+    });
+    fontFamilyAction->setCheckable(true);
+    fontFamilyAction->setActionGroup(&fontFamilyGroup_);
+    fontFamilyAction->setData(family);
+  }
+  loadConfig();
+}
+
 void Clock::loadConfig() {
   use24HourClockAction_->setChecked(model_->use24HourClock());
   setFontScaleFactor(model_->clockFontScaleFactor());
+  const QString fontFamily = model_->clockFontFamily();
+  for (QAction* action : fontFamilyGroup_.actions()) {
+    action->setChecked(action->data().toString() == fontFamily);
+  }
 }
 
 void Clock::saveConfig() {
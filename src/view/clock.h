@@ -21,11 +21,16 @@
 
 #include "iconless_dock_item.h"
 
+#include <unordered_map>
+
 #include <QAction>
 #include <QActionGroup>
+#include <QFont>
 #include <QMenu>
 #include <QObject>
+#include <QRect>
 #include <QString>
+#include <QTimer>
 
 #include "calendar.h"
 
@@ -57,6 +62,12 @@ class Clock : public QObject, public IconlessDockItem {
  private:
   static constexpr float kWhRatio = 2.9;
   static constexpr float kDelta = 0.01;
+  static constexpr int kMsPerMinute = 60 * 1000;
+  // To make sure that the timer fires after the minute has changed.
+  static constexpr int kUpdateSlackMs = 10;
+  // The timer does not count the time suspended, so it also fires this often
+  // to catch up soon after a resume.
+  static constexpr int kMaxUpdateIntervalMs = 5000;
 
   float fontScaleFactor() {
     return largeFontAction_->isChecked()
@@ -67,6 +78,19 @@ class Clock : public QObject, public IconlessDockItem {
 
   // Creates the context menu.
   void createMenu();
+  void createFontFamilyMenu();
+
+  // Schedules the next update at the start of the next minute, as the time
+  // is shown without the seconds, or in kMaxUpdateIntervalMs if sooner.
+  void scheduleUpdate();
+
+  int currentMinute() const;
+
+  // The area to repaint for the time, including the 3D style's reflection.
+  QRect getUpdateRect() const;
+
+  // Gets the font for the item's size, from the cache if possible.
+  const QFont& getFont(int w, int h, const QString& timeFormat) const;
 
   void saveConfig();
 
@@ -80,7 +104,22 @@ class Clock : public QObject, public IconlessDockItem {
   QAction* mediumFontAction_;
   QAction* smallFontAction_;
 
+  QMenu* fontFamilyMenu_;
   QActionGroup fontFamilyGroup_;
+
+  QTimer updateTimer_;
+
+  // The fonts per width and height, for the font family and scale factor.
+  mutable std::unordered_map<qint64, QFont> fonts_;
+  mutable QString fontFamily_;
+  mutable float fontScaleFactor_ = 0;
+  mutable QString fontTimeFormat_;
+
+  // The time as shown, for its minute of the day and the time format. The minute
+  // is also checked when drawing, in case something else repaints first.
+  mutable QString time_;
+  mutable int timeMinute_ = -1;
+  mutable QString timeFormat_;
 };
 
 }  // namespace crystaldock
@@ -72,8 +72,9 @@ class DockItem {
   // has been changed by another dock (not their parent dock).
   virtual void loadConfig() {}
 
-  // Handles adding the task, e.g. for a Program dock item.
-  virtual bool addTask(const WindowInfo* task) { return false; }
+  // Handles adding the task, e.g. for a Program dock item. `app` is the
+  // application entry of the task, already resolved by the caller.
+  virtual bool addTask(const WindowInfo* task, const ApplicationEntry* app) { return false; }
 
   // Handles updating the task, e.g. for a Program dock item.
   virtual bool updateTask(const WindowInfo* task) { return false; }
@@ -22,6 +22,8 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <unordered_set>
 #include <utility>
 
 #include <QColor>
@@ -114,8 +116,12 @@ DockPanel::DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId)
           this, SLOT(onWindowStateChanged(const WindowInfo*)));
   connect(WindowSystem::self(), SIGNAL(windowTitleChanged(const WindowInfo*)),
           this, SLOT(onWindowTitleChanged(const WindowInfo*)));
+  connect(WindowSystem::self(), SIGNAL(windowIconChanged(const WindowInfo*)),
+          this, SLOT(onWindowIconChanged(const WindowInfo*)));
   connect(WindowSystem::self(), SIGNAL(activeWindowChanged(void*)),
           this, SLOT(onActiveWindowChanged()));
+  connect(WindowSystem::self(), SIGNAL(initialWindowsLoaded()),
+          this, SLOT(onInitialWindowsLoaded()));
   connect(WindowSystem::self(), SIGNAL(windowAdded(const WindowInfo*)),
           this, SLOT(onWindowAdded(const WindowInfo*)));
   connect(WindowSystem::self(), SIGNAL(windowRemoved(void*)),
@@ -299,6 +305,18 @@ void DockPanel::removeDock() {
   }
 }
 
+void DockPanel::onInitialWindowsLoaded() {
+  intellihideHideUnhide();
+  if (autoHide() && !isHidden_) { setAutoHide(); }
+
+  if (!showTaskManager()) {
+    return;
+  }
+
+  initTasks();
+  resizeTaskManager();
+}
+
 void DockPanel::onWindowAdded(const WindowInfo* info) {
   intellihideHideUnhide();
   if (autoHide() && !isHidden_) { setAutoHide(); }
@@ -397,6 +415,20 @@ void DockPanel::onWindowTitleChanged(const WindowInfo *task) {
   }
 }
 
+void DockPanel::onWindowIconChanged(const WindowInfo *task) {
+  for (auto& item : items_) {
+    if (item->hasTask(task->window)) {
+      // Only programs without an App Menu entry use the window's own icon.
+      Program* program = dynamic_cast<Program*>(item.get());
+      if (program && !program->isAppMenuEntry() && !task->iconImage.isNull()) {
+        program->setIcon(QPixmap::fromImage(task->iconImage));
+        update();
+      }
+      return;
+    }
+  }
+}
+
 void DockPanel::onActiveWindowChanged() {
   update();
 }
@@ -1280,18 +1312,24 @@ bool DockPanel::addTask(const WindowInfo* task) {
     return false;
   }
 
+  // Resolves the application once for all items.
+  auto app = model_->findApplication(task->appId);
+
   // Tries adding the task to existing programs.
   for (auto& item : items_) {
-    if (item->addTask(task)) {
+    if (item->addTask(task, app)) {
       return false;
     }
   }
 
   // Adds a new program.
-  auto app = model_->findApplication(task->appId);
   if (!app && !task->appId.empty()) {
-    std::cerr << "Could not find application with id: " << task->appId
-              << ". The window icon will have limited functionalities." << std::endl;
+    // Only reported once per app ID, not for every window.
+    static std::unordered_set<std::string> reportedAppIds;
+    if (reportedAppIds.insert(task->appId).second) {
+      std::cerr << "Could not find application with id: " << task->appId
+                << ". The window icon will have limited functionalities." << std::endl;
+    }
   }
   const QString label = app ? app->name : QString::fromStdString(task->title);
   const QString appId = app ? app->appId : QString::fromStdString(task->appId);
@@ -1299,6 +1337,9 @@ bool DockPanel::addTask(const WindowInfo* task) {
   QString taskIconName = QString::fromStdString(task->icon);
   QPixmap taskIcon = appIcon.isNull() && !taskIconName.isEmpty()
       ? loadIcon(taskIconName, kIconLoadSize) : QPixmap();
+  if (appIcon.isNull() && taskIcon.isNull() && !task->iconImage.isNull()) {
+    taskIcon = QPixmap::fromImage(task->iconImage);
+  }
   if (app && appIcon.isNull()) {
     std::cerr << "Could not find icon with name: " << app->icon.toStdString()
               << " in the current icon theme and its fallbacks."
@@ -1323,7 +1364,7 @@ bool DockPanel::addTask(const WindowInfo* task) {
     items_.insert(items_.begin() + i, std::make_unique<Program>(
         this, model_, appId, label, orientation_, QPixmap(), minSize_, maxSize_));
   }
-  items_[i]->addTask(task);
+  items_[i]->addTask(task, app);
 
   return true;
 }
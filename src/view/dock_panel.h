@@ -250,6 +250,7 @@ class DockPanel : public QWidget {
   void cloneDock();
   void removeDock();
 
+  void onInitialWindowsLoaded();
   void onWindowAdded(const WindowInfo* info);
   void onWindowRemoved(void* window);
   void onWindowLeftCurrentDesktop(void* window);
@@ -257,6 +258,7 @@ class DockPanel : public QWidget {
   void onWindowGeometryChanged(const WindowInfo* task);
   void onWindowStateChanged(const WindowInfo* info);
   void onWindowTitleChanged(const WindowInfo* info);
+  void onWindowIconChanged(const WindowInfo* info);
   void onActiveWindowChanged();
   void onWindowEnteredOutput(const WindowInfo*, const wl_output*);
   void onWindowLeftOutput(const WindowInfo*, const wl_output*);
@@ -18,13 +18,11 @@
 
 #include "keyboard_layout.h"
 
-#include <iostream>
-
 #include <QMessageBox>
-#include <QProcess>
 #include <QTimer>
 
 #include "dock_panel.h"
+#include <model/status_hub.h>
 
 #include <utils/command_utils.h>
 #include <utils/draw_utils.h>
@@ -34,10 +32,7 @@ namespace crystaldock {
 KeyboardLayout::KeyboardLayout(DockPanel* parent, MultiDockModel* model,
                                Qt::Orientation orientation, int minSize, int maxSize)
     : IconBasedDockItem(parent, model, kLabel, orientation, kIcon,
-                        minSize, maxSize),
-    process_(nullptr) {
-  initKeyboardLayouts();
-
+                        minSize, maxSize) {
   connect(&menu_, &QMenu::triggered, this, &KeyboardLayout::onKeyboardLayoutSelected);
 
   connect(&menu_, &QMenu::aboutToHide, this,
@@ -48,13 +43,21 @@ KeyboardLayout::KeyboardLayout(DockPanel* parent, MultiDockModel* model,
           [this]() {
             parent_->setShowingPopup(false);
           });
+
+  // The keyboard layouts are shared by all docks.
+  KeyboardLayoutProvider* provider = StatusHub::self()->keyboardLayout();
+  connect(provider, &KeyboardLayoutProvider::layoutsLoaded,
+          this, &KeyboardLayout::onKeyboardLayoutsLoaded);
+  connect(provider, &KeyboardLayoutProvider::activeEngineChanged,
+          this, &KeyboardLayout::onActiveEngineChanged);
+  provider->subscribe();
+  if (provider->layouts()) {
+    onKeyboardLayoutsLoaded(provider->layouts());
+  }
 }
 
 KeyboardLayout::~KeyboardLayout() {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    process_->kill();
-    process_->waitForFinished(1000);
-  }
+  StatusHub::self()->keyboardLayout()->unsubscribe();
 }
 
 void KeyboardLayout::draw(QPainter* painter) const {
@@ -70,12 +73,12 @@ void KeyboardLayout::draw(QPainter* painter) const {
 
 void KeyboardLayout::mousePressEvent(QMouseEvent* e) {
   if (e->button() == Qt::LeftButton) {
-    if (commandExists({kCommand}).isEmpty()) {
+    if (!StatusHub::self()->keyboardLayout()->usesIBusBus() && commandExists({kCommand}).isEmpty()) {
       QMessageBox::warning(parent_, "Command not found",
                            QString("Command '") + kCommand + "' not found. This is required by the "
                                + kLabel + " component.");
       return;
-    } else if (!ibusReady_) {
+    } else if (!keyboardLayouts_) {
       QMessageBox::warning(parent_, "IBus is not running",
                            "Please make sure the IBus daemon is running.");
       return;
@@ -98,90 +101,44 @@ void KeyboardLayout::onKeyboardLayoutSelected(QAction* action) {
 }
 
 void KeyboardLayout::setKeyboardLayout(const KeyboardLayoutInfo& layout) {
-  // Prevent concurrent processes
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  process_ = new QProcess(parent_);
-  connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this, layout](int exitCode, QProcess::ExitStatus exitStatus) {
-            // Somehow IBus returns 1 here even when it succeeded.
-            activeKeyboardLayout_ = layout;
-            model_->setActiveKeyboardLayout(activeKeyboardLayout_.engine);
-            model_->saveAppearanceConfig(/*repaintOnly=*/true);
-            process_->deleteLater();
-            process_ = nullptr;
-          });
+  StatusHub::self()->keyboardLayout()->setActiveEngine(layout.engine);
+}
 
-  process_->start(kCommand, QStringList() << "engine" << layout.engine);
+void KeyboardLayout::onKeyboardLayoutsLoaded(
+    const std::shared_ptr<const KeyboardLayouts>& layouts) {
+  keyboardLayouts_ = layouts;
+  parent_->editKeyboardLayoutsDialog_.setKeyboardLayouts(
+      keyboardLayouts_->layouts, keyboardLayouts_->engines);
+  QString activeLayout = model_->activeKeyboardLayout();
+  if (activeLayout.isEmpty() || keyboardLayouts_->engines.count(activeLayout) == 0) {
+    activeLayout = StatusHub::self()->keyboardLayout()->activeEngine();
+    if (activeLayout.isEmpty() || keyboardLayouts_->engines.count(activeLayout) == 0) {
+      return;
+    }
+    model_->setActiveKeyboardLayout(activeLayout);
+  }
+  initUserKeyboardLayouts(activeLayout);
 }
 
-void KeyboardLayout::initKeyboardLayouts() {
-  if (process_ && process_->state() != QProcess::NotRunning) {
+void KeyboardLayout::onActiveEngineChanged(const QString& engine) {
+  if (!keyboardLayouts_) {
     return;
   }
-
-  process_ = new QProcess(parent_);
-  connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              ibusReady_ = true;
-              QRegularExpression languageRe(R"(language:\s+(.+))");
-              QRegularExpression keyboardRe(R"(\s*(.+)\s+-\s+(.+))");
-              QString language;
-              for (const QByteArray& line : process_->readAllStandardOutput().split('\n')) {
-                QRegularExpressionMatch match = languageRe.match(line);
-                if (match.hasMatch()) {
-                  language = match.captured(1).trimmed();
-                } else {
-                  match = keyboardRe.match(line);
-                  if (match.hasMatch()) {
-                    QString engine = match.captured(1).trimmed();
-                    QString description = match.captured(2).trimmed();
-                    if (!language.isEmpty()) {
-                      if (keyboardLayouts_.count(language) == 0) {
-                        keyboardLayouts_[language] = std::vector<KeyboardLayoutInfo>();
-                      }
-                      keyboardLayouts_[language].push_back(
-                          KeyboardLayoutInfo(language, engine, description));
-                      keyboardEngines_[engine] = keyboardLayouts_[language].back();
-                    }
-                  }
-                }
-              }
-
-              parent_->editKeyboardLayoutsDialog_.setKeyboardLayouts(
-                  keyboardLayouts_, keyboardEngines_);
-              QString activeLayout = model_->activeKeyboardLayout();
-              if (!activeLayout.isEmpty() && keyboardEngines_.count(activeLayout) > 0) {
-                initUserKeyboardLayouts(activeLayout);
-              } else {
-                // Gets the currently active keyboard layout.
-                QProcess* process = new QProcess(parent_);
-                connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                    [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
-                      if (exitCode == 0) {
-                        const QString ibusActiveLayout = process->readAllStandardOutput().trimmed();
-                        if (!ibusActiveLayout.isEmpty() && keyboardEngines_.count(ibusActiveLayout) > 0) {
-                          initUserKeyboardLayouts(ibusActiveLayout);
-                          model_->setActiveKeyboardLayout(ibusActiveLayout);
-                        }
-                      }
-                      process->deleteLater();
-                    });
-                process->start(kCommand, QStringList() << "engine");
-              }
-            }
-            process_->deleteLater();
-            process_ = nullptr;
-          });
-
-  process_->start(kCommand, QStringList() << "list-engine");
+  if (auto it = keyboardLayouts_->engines.find(engine); it != keyboardLayouts_->engines.end()) {
+    activeKeyboardLayout_ = it->second;
+  }
+  // The model is shared, so only the first dock to be notified saves it.
+  if (model_->activeKeyboardLayout() != engine) {
+    model_->setActiveKeyboardLayout(engine);
+    model_->saveAppearanceConfig(/*repaintOnly=*/true);
+  } else {
+    parent_->update();
+  }
 }
 
 void KeyboardLayout::initUserKeyboardLayouts(const QString& activeLayout) {
-  activeKeyboardLayout_ = keyboardEngines_[activeLayout];
+  const auto& engines = keyboardLayouts_->engines;
+  activeKeyboardLayout_ = engines.at(activeLayout);
   QStringList userLayouts = model_->userKeyboardLayouts();
   if (userLayouts.isEmpty()) {
     model_->setUserKeyboardLayouts(QStringList() << activeLayout);
@@ -190,8 +147,8 @@ void KeyboardLayout::initUserKeyboardLayouts(const QString& activeLayout) {
     userLayouts << activeLayout;
   }
   for (const auto& layout : userLayouts) {
-    if (keyboardEngines_.count(layout) > 0) {
-      userKeyboardLayouts_.push_back(keyboardEngines_[layout]);
+    if (auto it = engines.find(layout); it != engines.end()) {
+      userKeyboardLayouts_.push_back(it->second);
     }
   }
   createMenu();
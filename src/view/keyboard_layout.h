@@ -21,36 +21,17 @@
 
 #include "icon_based_dock_item.h"
 
-#include <map>
+#include <memory>
 #include <vector>
 
 #include <QAction>
 #include <QMenu>
 #include <QMouseEvent>
-#include <QProcess>
 #include <QString>
 
-namespace crystaldock {
-
-struct KeyboardLayoutInfo {
-  QString language;
-  QString languageCode;
-  QString engine;
-  QString description;
-
-  KeyboardLayoutInfo() = default;
-
-  KeyboardLayoutInfo(const QString& language2, const QString& engine2, const QString& description2)
-      : language(language2), engine(engine2), description(description2) {
-    if (language.size() >= 2) {
-      languageCode = language.first(2).toUpper();
-    }
-  }
-
-  bool isEmpty() const { return engine.isEmpty(); }
+#include <model/keyboard_layout_provider.h>
 
-  QString toString() const { return language + " - " + description; }
-};
+namespace crystaldock {
 
 // A keyboard layout manager that integrates with IBus.
 class KeyboardLayout : public QObject, public IconBasedDockItem {
@@ -69,33 +50,26 @@ class KeyboardLayout : public QObject, public IconBasedDockItem {
  public slots:
   void onKeyboardLayoutSelected(QAction* action);
   void setKeyboardLayout(const KeyboardLayoutInfo& layout);
+  void onKeyboardLayoutsLoaded(const std::shared_ptr<const KeyboardLayouts>& layouts);
+  void onActiveEngineChanged(const QString& engine);
 
  private:
   static constexpr char kCommand[] = "ibus";
   static constexpr char kLabel[] = "Keyboard Layout";
   static constexpr char kIcon[] = "input-keyboard";
-  static constexpr int kUpdateInterval = 1000;  // 1 second.
 
-  void initKeyboardLayouts();
   void initUserKeyboardLayouts(const QString& activeLayout);
 
   // Creates the context menu.
   void createMenu();
 
-  // All the available keyboard layouts, as map from languages to list of structs.
-  std::map<QString, std::vector<KeyboardLayoutInfo>> keyboardLayouts_;
-  // All the available keyboard layouts, as map from engines to structs.
-  std::map<QString, KeyboardLayoutInfo> keyboardEngines_;
+  // All the available keyboard layouts, null until IBus is ready.
+  std::shared_ptr<const KeyboardLayouts> keyboardLayouts_;
   // The user-selected keyboard layouts for quick switching.
   std::vector<KeyboardLayoutInfo> userKeyboardLayouts_;
   // The active keyboard layout.
   KeyboardLayoutInfo activeKeyboardLayout_;
 
-  bool ibusReady_ = false;
-
-  // ibus process.
-  QProcess* process_ = nullptr;
-
   // Left-click volume menu.
   QMenu menu_;
   // Right-click context menu.
@@ -104,6 +78,4 @@ class KeyboardLayout : public QObject, public IconBasedDockItem {
 
 }  // namespace crystaldock
 
-Q_DECLARE_METATYPE(crystaldock::KeyboardLayoutInfo);
-
 #endif  // CRYSTAL_DOCK_KEYBOARD_LAYOUT_H_
@@ -31,6 +31,7 @@
 #include "display/window_system.h"
 
 #include "dock_panel.h"
+#include <utils/command_runner.h>
 #include <utils/draw_utils.h>
 
 namespace crystaldock {
@@ -238,12 +239,11 @@ QString Program::getLabel() const {
       label_;
 }
 
-bool Program::addTask(const WindowInfo* task) {
+bool Program::addTask(const WindowInfo* task, const ApplicationEntry* app) {
   if (!model_->groupTasksByApplication() && !tasks_.empty()) {
     return false;
   }
 
-  auto* app = model_->findApplication(task->appId);
   if ((app && app->appId == appId_) || task->appId == appId_.toStdString()) {
     tasks_.push_back(ProgramTask(task->window, QString::fromStdString(task->title),
                                  task->demandsAttention));
@@ -335,17 +335,15 @@ void Program::pinUnpin() {
 
 void Program::launch(const QString& command) {
   QStringList list = QProcess::splitCommand(command);
-  QProcess process;
-  process.setProgram(list.at(0));
-  process.setArguments(list.mid(1));
+  if (list.isEmpty()) {
+    return;
+  }
   auto env = QProcessEnvironment::systemEnvironment();
   // Unset XDG_ACTIVATION_TOKEN.
   env.insert("XDG_ACTIVATION_TOKEN", "");
   // Unset layer-shell env.
   env.insert("QT_WAYLAND_SHELL_INTEGRATION", "");
-  process.setProcessEnvironment(env);
-  process.setWorkingDirectory(QDir::homePath());
-  if (!process.startDetached()) {
+  if (!CommandRunner::self()->launch(list.at(0), list.mid(1), env, QDir::homePath())) {
     QMessageBox warning(QMessageBox::Warning, "Error",
                         QString("Could not run command: ") + command,
                         QMessageBox::Ok, nullptr, Qt::Tool);
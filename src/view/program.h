@@ -73,7 +73,7 @@ class Program : public QObject, public IconBasedDockItem {
     pinAction_->setChecked(pinned_);
   }
 
-  bool addTask(const WindowInfo* task) override;
+  bool addTask(const WindowInfo* task, const ApplicationEntry* app) override;
 
   bool updateTask(const WindowInfo* task) override;
 
@@ -104,6 +104,8 @@ class Program : public QObject, public IconBasedDockItem {
     return -1;
   }
 
+  bool isAppMenuEntry() const { return isAppMenuEntry_; }
+
   bool pinned() { return pinned_; }
   void pinUnpin();
 
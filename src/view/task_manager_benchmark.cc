@@ -0,0 +1,238 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headless task manager throughput benchmark. Builds real docks on top of a
+// fake window manager and fires storms of window and desktop events:
+//
+//   task_manager_benchmark [--docks=N] [--windows=N] [--events=N] [--desktops=N]
+//                          [--apps=N] [--seed=N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QApplication>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <display/fake_window_manager.h>
+#include <display/window_system.h>
+#include <model/multi_dock_model.h>
+#include <view/multi_dock_view.h>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace crystaldock {
+namespace {
+
+struct Options {
+  int docks = 1;
+  int windows = 200;
+  int events = 20000;
+  int desktops = 4;
+  int apps = 50;
+  unsigned int seed = 1;
+};
+
+enum class EventType { Add, Remove, Title, Geometry, DesktopSwitch, Count };
+
+Options parseOptions(const QStringList& args) {
+  Options options;
+  for (const auto& arg : args) {
+    const auto parts = arg.split("=");
+    if (parts.size() != 2) {
+      continue;
+    }
+    const int value = parts[1].toInt();
+    if (parts[0] == "--docks") {
+      options.docks = value;
+    } else if (parts[0] == "--windows") {
+      options.windows = value;
+    } else if (parts[0] == "--events") {
+      options.events = value;
+    } else if (parts[0] == "--desktops") {
+      options.desktops = value;
+    } else if (parts[0] == "--apps") {
+      options.apps = value;
+    } else if (parts[0] == "--seed") {
+      options.seed = value;
+    }
+  }
+  return options;
+}
+
+int run(const Options& options) {
+  QTemporaryDir configDir;
+  if (!configDir.isValid()) {
+    std::cerr << "Could not create temporary config dir" << std::endl;
+    return -1;
+  }
+
+  FakeWindowManager::init(options.desktops);
+  MultiDockModel model(configDir.path());
+  for (int i = 0; i < options.docks; ++i) {
+    model.addDock(PanelPosition::Bottom, /*screen=*/0, PanelVisibility::AlwaysVisible,
+                  /*showApplicationMenu=*/true, /*showPager=*/true,
+                  /*showTaskManager=*/true, /*showTrash=*/false,
+                  /*showWifiManager=*/false, /*showVolumeControl=*/false,
+                  /*showBatteryIndicator=*/false, /*showKeyboardLayout=*/false,
+                  /*showVersionChecker=*/false, /*showClock=*/false);
+  }
+  MultiDockView view(&model);
+  view.show();
+  QApplication::processEvents();
+
+  std::mt19937 random(options.seed);
+  auto randomInt = [&random](int max) {
+    return std::uniform_int_distribution<int>(0, max - 1)(random);
+  };
+  auto randomAppId = [&] { return "benchmark-app-" + std::to_string(randomInt(options.apps)); };
+  auto randomDesktop = [&] {
+    return options.desktops > 0 ? "desktop-" + std::to_string(1 + randomInt(options.desktops))
+                                : std::string();
+  };
+
+  // Unknown app IDs are expected, don't flood the output.
+  auto* cerrBuffer = std::cerr.rdbuf(nullptr);
+
+  std::vector<void*> windows;
+  for (int i = 0; i < options.windows; ++i) {
+    windows.push_back(FakeWindowManager::addWindow(
+        randomAppId(), "Window " + std::to_string(i), randomDesktop()));
+  }
+  QApplication::processEvents();
+
+  std::vector<double> latencies;
+  latencies.reserve(options.events);
+  uint64_t allocations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < options.events; ++i) {
+    auto type = static_cast<EventType>(randomInt(static_cast<int>(EventType::Count)));
+    // Keeps the number of windows around the initial number.
+    if (type == EventType::Add && static_cast<int>(windows.size()) >= 2 * options.windows) {
+      type = EventType::Remove;
+    }
+    if (type != EventType::Add && windows.empty()) {
+      type = EventType::Add;
+    }
+    if (type == EventType::DesktopSwitch && options.desktops == 0) {
+      type = EventType::Title;
+    }
+
+    // Prepares the arguments before measuring.
+    const int index = windows.empty() ? 0 : randomInt(windows.size());
+    const std::string text = (type == EventType::Add) ? randomAppId()
+        : (type == EventType::DesktopSwitch) ? randomDesktop()
+        : "Title " + std::to_string(i);
+    const std::string desktop = randomDesktop();
+    const int x = randomInt(1920);
+    const int y = randomInt(1080);
+    windows.reserve(windows.size() + 1);
+
+    const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    const auto eventStart = std::chrono::steady_clock::now();
+    switch (type) {
+      case EventType::Add:
+        windows.push_back(FakeWindowManager::addWindow(text, text, desktop));
+        break;
+      case EventType::Remove:
+        FakeWindowManager::removeWindow(windows[index]);
+        windows[index] = windows.back();
+        windows.pop_back();
+        break;
+      case EventType::Title:
+        FakeWindowManager::setWindowTitle(windows[index], text);
+        break;
+      case EventType::Geometry:
+        FakeWindowManager::setWindowGeometry(windows[index], x, y, 800, 600);
+        break;
+      case EventType::DesktopSwitch:
+        FakeWindowManager::setCurrentDesktop(text);
+        break;
+      default:
+        break;
+    }
+    latencies.push_back(std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - eventStart).count());
+    allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+    // Lets deferred work (e.g. repaints) run like it would in the real event loop.
+    if (i % 100 == 99) {
+      QApplication::processEvents();
+    }
+  }
+  QApplication::processEvents();
+  const double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::cerr.rdbuf(cerrBuffer);
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    return latencies.empty()
+        ? 0.0 : latencies[std::min(latencies.size() - 1,
+                                   static_cast<size_t>(p * latencies.size()))];
+  };
+  std::cout << "Docks: " << options.docks << ", windows: " << options.windows
+            << ", events: " << options.events << std::endl;
+  std::cout << "Events/s: " << (elapsed > 0 ? options.events / elapsed : 0) << std::endl;
+  std::cout << "Handler latency p50: " << percentile(0.5) << " us, p99: "
+            << percentile(0.99) << " us" << std::endl;
+  std::cout << "Allocations/event: "
+            << (options.events > 0 ? static_cast<double>(allocations) / options.events : 0)
+            << std::endl;
+  return 0;
+}
+
+}  // namespace
+}  // namespace crystaldock
+
+int main(int argc, char** argv) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QApplication app(argc, argv);
+  return crystaldock::run(crystaldock::parseOptions(app.arguments()));
+}
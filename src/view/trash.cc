@@ -19,16 +19,13 @@
 #include "trash.h"
 
 #include <QApplication>
-#include <QDateTime>
 #include <QDir>
-#include <QFileInfo>
+#include <QLocale>
 #include <QMouseEvent>
 #include <QPainter>
-#include <QProcess>
-#include <QProcessEnvironment>
-#include <QStandardPaths>
-#include <QTextStream>
 
+#include <model/trash_jobs.h>
+#include <utils/command_runner.h>
 #include <utils/draw_utils.h>
 #include <utils/font_utils.h>
 
@@ -52,6 +49,16 @@ Trash::Trash(DockPanel* parent, MultiDockModel* model, Qt::Orientation orientati
   createMenu();
   setupTrashWatcher();
   updateTrashState();
+
+  // The trash jobs run in the background and are shared by all docks.
+  connect(TrashJobs::self(), &TrashJobs::progressChanged, this, [this] {
+    parent_->update();
+  });
+  connect(TrashJobs::self(), &TrashJobs::jobFinished, this, &Trash::updateTrashState);
+  connect(TrashJobs::self(), &TrashJobs::sizeChanged, this, [this] {
+    parent_->update();
+  });
+
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
             parent_->setShowingPopup(false);
@@ -80,12 +87,26 @@ void Trash::mousePressEvent(QMouseEvent* e) {
 }
 
 QString Trash::getLabel() const {
-  return isEmpty_ ? "Trash (Empty)" : "Trash (Full)";
+  const auto* jobs = TrashJobs::self();
+  if (jobs->isBusy() && !jobs->progress().isEmpty()) {
+    return "Trash (" + jobs->progress() + ")";
+  }
+  const TrashSize& size = jobs->size();
+  if (isEmpty_ || size.numItems == 0) {
+    // The size might not have been computed yet.
+    return isEmpty_ ? "Trash (Empty)" : "Trash (Full)";
+  }
+  return QString("Trash (%1 %2, %3)")
+      .arg(size.numItems)
+      .arg(size.numItems == 1 ? "item" : "items")
+      .arg(QLocale::system().formattedDataSize(size.numBytes));
 }
 
 void Trash::updateTrashState() {
   bool wasEmpty = isEmpty_;
   isEmpty_ = isTrashEmpty();
+  // In the background, as the trash can be large.
+  TrashJobs::self()->updateSize();
   
   if (isEmpty_ != wasEmpty) {
     updateIcon();
@@ -97,40 +118,31 @@ void Trash::emptyTrash() {
   if (isEmpty_) {
     return;
   }
-  
-  QDir trashFilesDir(trashFilesPath_);
-  QDir trashInfoDir(trashInfoPath_);
-  
-  trashFilesDir.removeRecursively();
-  trashInfoDir.removeRecursively();
-  
-  QDir().mkpath(trashFilesPath_);
-  QDir().mkpath(trashInfoPath_);
-  
-  updateTrashState();
+
+  TrashJobs::self()->emptyTrash();
 }
 
 void Trash::openTrash() {
-  QProcess* process = new QProcess(parent_);
-  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
-            // Tries to find the default file manager. Falls back to using "xdg-open".
-            QString command = "xdg-open";
-            if (exitCode == 0) {
-              QString desktopFile = process->readAllStandardOutput().trimmed();
-              if (desktopFile.endsWith(".desktop")) {
-                desktopFile = desktopFile.first(desktopFile.size() - 8);
-              }
-              const auto* fileManager = model_->findApplication(desktopFile.toStdString());
-              if (fileManager != nullptr) {
-                command = fileManager->command;
-              }
-            }
+  CommandOptions options;
+  options.timeoutMs = kQueryTimeoutMs;
+  options.coalesce = true;
+  CommandRunner::self()->run("xdg-mime", {"query", "default", "inode/directory"}, this,
+                             [this](const CommandResult& result) {
+    // Tries to find the default file manager. Falls back to using "xdg-open".
+    QString command = "xdg-open";
+    if (result.ok()) {
+      QString desktopFile = QString(result.output).trimmed();
+      if (desktopFile.endsWith(".desktop")) {
+        desktopFile = desktopFile.first(desktopFile.size() - 8);
+      }
+      const auto* fileManager = model_->findApplication(desktopFile.toStdString());
+      if (fileManager != nullptr) {
+        command = fileManager->command;
+      }
+    }
 
-            Program::launch(command + " trash:/");
-            process->deleteLater();
-          });
-  process->start("xdg-mime", QStringList() << "query" << "default" << "inode/directory");
+    Program::launch(command + " trash:/");
+  }, options);
 }
 
 void Trash::setAcceptDrops(bool accept) {
@@ -179,43 +191,7 @@ void Trash::createMenu() {
 }
 
 void Trash::moveToTrash(const QStringList& filePaths) {
-  for (const QString& filePath : filePaths) {
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
-      continue;
-    }
-    
-    QString fileName = fileInfo.fileName();
-    QString destPath = trashFilesPath_ + "/" + fileName;
-    QString infoPath = trashInfoPath_ + "/" + fileName + ".trashinfo";
-    
-    int counter = 1;
-    while (QFile::exists(destPath)) {
-      QString baseName = fileInfo.baseName();
-      QString suffix = fileInfo.completeSuffix();
-      if (!suffix.isEmpty()) {
-        fileName = QString("%1_%2.%3").arg(baseName).arg(counter).arg(suffix);
-      } else {
-        fileName = QString("%1_%2").arg(baseName).arg(counter);
-      }
-      destPath = trashFilesPath_ + "/" + fileName;
-      infoPath = trashInfoPath_ + "/" + fileName + ".trashinfo";
-      counter++;
-    }
-    
-    if (QFile::rename(filePath, destPath)) {
-      QFile infoFile(infoPath);
-      if (infoFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream stream(&infoFile);
-        stream << "[Trash Info]\n";
-        stream << "Path=" << filePath << "\n";
-        stream << "DeletionDate=" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
-        infoFile.close();
-      }
-    }
-  }
-  
-  updateTrashState();
+  TrashJobs::self()->moveToTrash(filePaths);
 }
 
 bool Trash::isTrashEmpty() const {
@@ -224,8 +200,7 @@ bool Trash::isTrashEmpty() const {
 }
 
 QString Trash::getTrashPath() const {
-  QString dataHome = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation);
-  return dataHome + "/Trash";
+  return TrashJobs::homeTrashPath();
 }
 
 QString Trash::getTrashInfoPath() const {
@@ -86,6 +86,7 @@ class Trash : public QObject, public IconBasedDockItem {
 
   static constexpr const char* kEmptyTrashIconName = "user-trash";
   static constexpr const char* kFullTrashIconName = "user-trash-full";
+  static constexpr int kQueryTimeoutMs = 2000;
 };
 
 }  // namespace crystaldock
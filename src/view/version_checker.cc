@@ -22,10 +22,10 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QOverload>
-#include <QProcess>
 #include <QTimer>
 
 #include "dock_panel.h"
+#include <utils/command_runner.h>
 
 namespace crystaldock {
 
@@ -75,31 +75,32 @@ void VersionChecker::checkVersion() {
     return;
   }
 
-  QProcess* curlProcess = new QProcess(parent_);
-  connect(curlProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this, curlProcess](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              const QString output = curlProcess->readAllStandardOutput();
-              const QJsonDocument jsonDoc = QJsonDocument::fromJson(output.toUtf8());
-              if (jsonDoc.isNull() || !jsonDoc.isObject()) {
-                return;
-              }
-              const QJsonObject json = jsonDoc.object();
-              if (!json.contains("tag_name")) {
-                return;
-              }
-              QString latestRelease = json.value("tag_name").toString().trimmed();
-              latestRelease = latestRelease.mid(latestRelease.indexOf("v") + 1);
-              const QString version = DockPanel::kVersion;
-              if (version == latestRelease) {
-                setVersionStatus(VersionStatus::UpToDate);
-              } else {
-                setVersionStatus(VersionStatus::OutOfDate);
-              }
-            }
-            curlProcess->deleteLater();
-          });
-  curlProcess->start("curl", QStringList() << "-s" << "https://api.github.com/repos/dangvd/crystal-dock/releases/latest");
+  CommandOptions options;
+  options.timeoutMs = kCheckTimeoutMs;
+  options.coalesce = true;
+  CommandRunner::self()->run(
+      "curl", {"-s", "https://api.github.com/repos/dangvd/crystal-dock/releases/latest"}, this,
+      [this](const CommandResult& result) {
+        if (!result.ok()) {
+          return;
+        }
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(result.output);
+        if (jsonDoc.isNull() || !jsonDoc.isObject()) {
+          return;
+        }
+        const QJsonObject json = jsonDoc.object();
+        if (!json.contains("tag_name")) {
+          return;
+        }
+        QString latestRelease = json.value("tag_name").toString().trimmed();
+        latestRelease = latestRelease.mid(latestRelease.indexOf("v") + 1);
+        const QString version = DockPanel::kVersion;
+        if (version == latestRelease) {
+          setVersionStatus(VersionStatus::UpToDate);
+        } else {
+          setVersionStatus(VersionStatus::OutOfDate);
+        }
+      }, options);
 }
 
 void VersionChecker::setVersionStatus(VersionStatus status) {
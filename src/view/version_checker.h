@@ -38,6 +38,8 @@ class VersionChecker : public QObject, public IconBasedDockItem {
   void mousePressEvent(QMouseEvent* e) override;
 
  private:
+  static constexpr int kCheckTimeoutMs = 30000;
+
   void checkVersion();
   void setVersionStatus(VersionStatus status);
   void createMenu();
@@ -24,32 +24,27 @@
 #include <QMessageBox>
 #include <QPainter>
 #include <QPainterPath>
-#include <QRegularExpression>
 #include <QWidgetAction>
 #include <QtMath>
 
 #include "dock_panel.h"
+#include <model/status_hub.h>
 #include <utils/command_utils.h>
 #include <utils/draw_utils.h>
 
 namespace crystaldock {
 
-constexpr int VolumeControl::kUpdateInterval;
-
 VolumeControl::VolumeControl(DockPanel* parent, MultiDockModel* model,
                             Qt::Orientation orientation, int minSize, int maxSize)
     : IconBasedDockItem(parent, model, "Volume Control", orientation, "audio-volume",
-                        minSize, maxSize),
-      updateTimer_(new QTimer(this)),
-      volumeProcess_(nullptr) {
+                        minSize, maxSize) {
   createMenu();
 
-  // Set up update timer
-  connect(updateTimer_, &QTimer::timeout, this, &VolumeControl::refreshVolumeInfo);
-  updateTimer_->start(kUpdateInterval);
-
-  // Initial volume info refresh
-  QTimer::singleShot(1000, this, &VolumeControl::refreshVolumeInfo);
+  // The volume state is shared by all docks.
+  connect(StatusHub::self()->volume(), &VolumeProvider::volumeChanged,
+          this, &VolumeControl::onVolumeChanged);
+  StatusHub::self()->volume()->subscribe();
+  onVolumeChanged(StatusHub::self()->volume()->info());
 
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
@@ -62,10 +57,7 @@ VolumeControl::VolumeControl(DockPanel* parent, MultiDockModel* model,
 }
 
 VolumeControl::~VolumeControl() {
-  if (volumeProcess_ && volumeProcess_->state() != QProcess::NotRunning) {
-    volumeProcess_->kill();
-    volumeProcess_->waitForFinished(1000);
-  }
+  StatusHub::self()->volume()->unsubscribe();
 }
 
 void VolumeControl::draw(QPainter* painter) const {
@@ -161,60 +153,14 @@ QString VolumeControl::getLabel() const {
   return isMuted_ ? "Volume: Muted" : QString("Volume: %1%").arg(currentVolume_);
 }
 
-void VolumeControl::refreshVolumeInfo() {
-  // Prevent concurrent processes
-  if (volumeProcess_ && volumeProcess_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  // Get volume level
-  volumeProcess_ = new QProcess(parent_);
-  connect(volumeProcess_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              const QString output = volumeProcess_->readAllStandardOutput();
-              QRegularExpression volumeRegex(R"((\d+)%)");
-              QRegularExpressionMatch match = volumeRegex.match(output);
-              if (match.hasMatch()) {
-                const int newVolume = match.captured(1).toInt();
-                if (newVolume != currentVolume_) {
-                  currentVolume_ = newVolume;
-                  updateUi();
-                }
-              }
-            }
-            volumeProcess_->deleteLater();
-            volumeProcess_ = nullptr;
-
-            // Check mute status
-            QProcess* muteProcess = new QProcess(parent_);
-            connect(muteProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                    [this, muteProcess](int exitCode, QProcess::ExitStatus exitStatus) {
-                      if (exitCode == 0) {
-                        const QString output = muteProcess->readAllStandardOutput().trimmed();
-                        const bool newMuted = (output.toLower().contains("yes"));
-                        if (newMuted != isMuted_) {
-                          isMuted_ = newMuted;
-                          updateUi();
-                        }
-                      }
-                      muteProcess->deleteLater();
-                    });
-            muteProcess->start(kCommand, QStringList() << "get-sink-mute" << "@DEFAULT_SINK@");
-          });
-
-  volumeProcess_->start(kCommand, QStringList() << "get-sink-volume" << "@DEFAULT_SINK@");
+void VolumeControl::onVolumeChanged(const VolumeInfo& info) {
+  currentVolume_ = info.volume;
+  isMuted_ = info.muted;
+  updateUi();
 }
 
 void VolumeControl::setVolume(int volume) {
-  QProcess* process = new QProcess(parent_);
-  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [process](int exitCode, QProcess::ExitStatus exitStatus) {
-            process->deleteLater();
-          });
-  currentVolume_ = volume;
-  updateUi();
-  process->start(kCommand, QStringList() << "set-sink-volume" << "@DEFAULT_SINK@" << QString("%1%").arg(volume));
+  StatusHub::self()->volume()->setVolume(volume);
 }
 
 void VolumeControl::onVolumeSliderChanged(int value) {
@@ -223,14 +169,7 @@ void VolumeControl::onVolumeSliderChanged(int value) {
 }
 
 void VolumeControl::toggleMute() {
-  QProcess* process = new QProcess(parent_);
-  connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [process](int exitCode, QProcess::ExitStatus exitStatus) {
-            process->deleteLater();
-          });
-  isMuted_ = !isMuted_;
-  updateUi();
-  process->start(kCommand, QStringList() << "set-sink-mute" << "@DEFAULT_SINK@" << "toggle");
+  StatusHub::self()->volume()->toggleMute();
 }
 
 void VolumeControl::createMenu() {
@@ -25,12 +25,12 @@
 #include <QActionGroup>
 #include <QMenu>
 #include <QObject>
-#include <QProcess>
 #include <QSlider>
 #include <QString>
-#include <QTimer>
 #include <QWheelEvent>
 
+#include <model/volume_provider.h>
+
 namespace crystaldock {
 
 // A volume control widget that integrates with PulseAudio.
@@ -49,7 +49,7 @@ class VolumeControl : public QObject, public IconBasedDockItem {
   bool beforeTask(const QString& program) override { return false; }
 
  public slots:
-  void refreshVolumeInfo();
+  void onVolumeChanged(const VolumeInfo& info);
   void onVolumeSliderChanged(int value);
   void toggleMute();
   void setVolumeScrollStep1();
@@ -59,7 +59,6 @@ class VolumeControl : public QObject, public IconBasedDockItem {
 
  private:
   static constexpr char kCommand[] = "pactl";
-  static constexpr int kUpdateInterval = 1000;
 
   // Creates the context menu.
   void createMenu();
@@ -73,12 +72,6 @@ class VolumeControl : public QObject, public IconBasedDockItem {
   int currentVolume_ = 50;
   bool isMuted_ = false;
 
-  // Update timer.
-  QTimer* updateTimer_;
-
-  // PulseAudio process for monitoring volume.
-  QProcess* volumeProcess_;
-
   // Left-click volume menu.
   QMenu menu_;
   QSlider* volumeSlider_;
@@ -18,11 +18,10 @@
 
 #include "wifi_manager.h"
 
-#include <algorithm>
-
-#include <QProcess>
+#include <QPointer>
 
 #include "dock_panel.h"
+#include <model/status_hub.h>
 
 namespace crystaldock {
 
@@ -44,19 +43,20 @@ WifiManager::WifiManager(DockPanel* parent, MultiDockModel* model,
             parent_->setShowingPopup(false);
           });
 
-  scanWifiNetworks();
+  // The networks are shared by all docks.
+  WifiProvider* provider = StatusHub::self()->wifi();
+  connect(provider, &WifiProvider::statusChanged, this, &WifiManager::onWifiStatusChanged);
+  provider->subscribe();
+  onWifiStatusChanged(provider->status());
 }
 
 WifiManager::~WifiManager() {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    process_->kill();
-    process_->waitForFinished(1000);
-  }
+  StatusHub::self()->wifi()->unsubscribe();
 }
 
 void WifiManager::mousePressEvent(QMouseEvent* e) {
   if (e->button() == Qt::LeftButton) {
-    if (commandExists({kCommand}).isEmpty()) {
+    if (!StatusHub::self()->wifi()->usesNetworkManager() && commandExists({kCommand}).isEmpty()) {
       QMessageBox::warning(parent_, "Command not found",
           QString("Command '") + kCommand + "' not found. This is required by the "
           + kLabel + " component.");
@@ -74,114 +74,51 @@ void WifiManager::onNetworkSelected(QAction* action) {
   connectionDialog_.show();
 }
 
+void WifiManager::onWifiStatusChanged(const std::shared_ptr<const WifiStatus>& status) {
+  status_ = status;
+  if (status_->scanned) {
+    const WifiNetwork* connected = status_->connectedNetwork();
+    setLabel(connected ? "Wi-Fi: Connected to " + connected->name : "Wi-Fi: Not connected");
+  }
+  updateWifiList();
+}
+
 void WifiManager::rescan() {
   info_.setText("Rescanning Wi-Fi networks...");
   parent_->minimize();
   QTimer::singleShot(DockPanel::kExecutionDelayMs, [this]{
     info_.show();
   });
-  scanWifiNetworks([this]() {
-    info_.setText("Rescanning completed");
+  QPointer<WifiManager> self(this);
+  StatusHub::self()->wifi()->rescan([self](bool ok) {
+    if (self) {
+      self->info_.setText(ok ? "Rescanning completed" : "Rescanning failed");
+    }
   });
 }
 
 void WifiManager::connectWifi(const QString &network, const QString &password) {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  process_ = new QProcess(parent_);
-  connect(process_, &QProcess::started,
-          [this, network, password]() {
-            process_->write((password + "\n").toStdString().c_str());
-            connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                    [this, network](int exitCode, QProcess::ExitStatus exitStatus) {
-                      if (exitCode == 0) {
-                        connectionDialog_.setInUse(true);
-                        setLabel("Wi-Fi: Connected to " + network);
-                        if (auto result = std::ranges::find(networks_, network, &WifiNetwork::name);
-                            result != networks_.end()) {
-                          result->inUse = true;
-                          updateWifiList();
-                        }
-                      } else {
-                        connectionDialog_.setStatus("Failed to connect");
-                      }
-                      process_->deleteLater();
-                      process_ = nullptr;
-                    });
-          });
-
-  process_->start(kCommand, {"dev", "wifi", "connect", network, "--ask"});
+  // The dock item might be gone when the command finishes.
+  QPointer<WifiManager> self(this);
+  StatusHub::self()->wifi()->connectWifi(network, password, [self](bool ok) {
+    if (!self) {
+      return;
+    }
+    if (ok) {
+      self->connectionDialog_.setInUse(true);
+    } else {
+      self->connectionDialog_.setStatus("Failed to connect");
+    }
+  });
 }
 
 void WifiManager::disconnectWifi(const QString &network) {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  process_ = new QProcess(parent_);
-  connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this, network](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              connectionDialog_.setInUse(false);
-              setLabel("Wi-Fi: Not connected");
-              if (auto result = std::ranges::find(networks_, network, &WifiNetwork::name);
-                  result != networks_.end()) {
-                result->inUse = false;
-                updateWifiList();
-              }
-            }
-            process_->deleteLater();
-            process_ = nullptr;
-          });
-
-  process_->start(kCommand, {"connection", "delete", network});
-}
-
-void WifiManager::scanWifiNetworks(std::function<void()> onSuccess) {
-  if (process_ && process_->state() != QProcess::NotRunning) {
-    return;
-  }
-
-  process_ = new QProcess(parent_);
-  connect(process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          [this, onSuccess](int exitCode, QProcess::ExitStatus exitStatus) {
-            if (exitCode == 0) {
-              networks_.clear();
-              bool connected = false;
-              for (const QString network : process_->readAllStandardOutput().split('\n')) {
-                QStringList fields = network.split(':');
-                if (fields.size() < 3) continue;
-                const QString& name = fields[0];
-                unsigned int signal = fields[1].toInt();
-                bool inUse = !fields[2].trimmed().isEmpty();
-                if (!name.isEmpty() && signal != 0) {
-                  WifiNetwork network = {
-                    .name = name,
-                    .signal = signal,
-                    .inUse = inUse
-                  };
-                  networks_.push_back(network);
-                  if (network.inUse) {
-                    setLabel("Wi-Fi: Connected to " + network.name);
-                    connected = true;
-                  }
-                }
-              }
-              if (!connected) {
-                setLabel("Wi-Fi: Not connected");
-              }
-              updateWifiList();
-              if (onSuccess) {
-                onSuccess();
-              }
-            }
-            process_->deleteLater();
-            process_ = nullptr;
-          });
-
-  process_->start(kCommand, {"--terse", "--fields", "SSID,SIGNAL,IN-USE", "dev", "wifi", "list"});
+  QPointer<WifiManager> self(this);
+  StatusHub::self()->wifi()->disconnectWifi(network, [self](bool ok) {
+    if (self && ok) {
+      self->connectionDialog_.setInUse(false);
+    }
+  });
 }
 
 void WifiManager::showWifiNetworks() {
@@ -189,12 +126,25 @@ void WifiManager::showWifiNetworks() {
 }
 
 void WifiManager::updateWifiList() {
-  menu_.clear();
-  for (const auto& network : networks_) {
+  // Updates the existing actions in place, as the list changes often but
+  // only slightly with NetworkManager's signal strength updates.
+  QList<QAction*> actions = menu_.actions();
+  const int numNetworks = static_cast<int>(status_->networks.size());
+  for (int i = 0; i < numNetworks; ++i) {
+    const auto& network = status_->networks[i];
     QString label = network.name + (network.inUse ? " (Connected)" : "");
-    QAction* action = new QAction(label, &menu_);
-    action->setData(QVariant::fromValue(network));
-    menu_.addAction(action);
+    if (i < actions.size()) {
+      actions[i]->setText(label);
+      actions[i]->setData(QVariant::fromValue(network));
+    } else {
+      QAction* action = new QAction(label, &menu_);
+      action->setData(QVariant::fromValue(network));
+      menu_.addAction(action);
+    }
+  }
+  for (int i = numNetworks; i < actions.size(); ++i) {
+    menu_.removeAction(actions[i]);
+    delete actions[i];
   }
 }
 
@@ -21,27 +21,21 @@
 
 #include "icon_based_dock_item.h"
 
-#include <functional>
+#include <memory>
 
 #include <QAction>
 #include <QMenu>
 #include <QMessageBox>
 #include <QMouseEvent>
-#include <QProcess>
 #include <QObject>
 #include <QString>
 
 #include "view/wifi_connection_dialog.h"
+#include <model/wifi_provider.h>
 
 namespace crystaldock {
 
-struct WifiNetwork {
-  QString name;
-  unsigned int signal;
-  bool inUse;
-};
-
-// A Wifi manager that integrates with nmcli.
+// A Wifi manager that integrates with NetworkManager.
 class WifiManager : public QObject, public IconBasedDockItem {
   Q_OBJECT
 
@@ -58,14 +52,15 @@ class WifiManager : public QObject, public IconBasedDockItem {
 
  public slots:
   void onNetworkSelected(QAction* action);
+  void onWifiStatusChanged(const std::shared_ptr<const WifiStatus>& status);
   void rescan();
 
  private:
+  // Required only without NetworkManager's D-Bus service.
   static constexpr char kCommand[] = "nmcli";
   static constexpr char kLabel[] = "Wi-Fi Manager";
   static constexpr char kIcon[] = "network-wireless";
 
-  void scanWifiNetworks(std::function<void()> onSuccess = nullptr);
   void showWifiNetworks();
 
   void updateWifiList();
@@ -73,9 +68,7 @@ class WifiManager : public QObject, public IconBasedDockItem {
   // Creates the context menu.
   void createMenu();
 
-  std::vector<WifiNetwork> networks_;
-  // nmcli process.
-  QProcess* process_ = nullptr;
+  std::shared_ptr<const WifiStatus> status_;
 
   // Left-click volume menu.
   QMenu menu_;
@@ -89,6 +82,4 @@ class WifiManager : public QObject, public IconBasedDockItem {
 
 }  // namespace crystaldock
 
-Q_DECLARE_METATYPE(crystaldock::WifiNetwork);
-
 #endif  // CRYSTAL_DOCK_WIFI_MANAGER_H_
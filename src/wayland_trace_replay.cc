@@ -0,0 +1,71 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Replays a Wayland event trace recorded with CRYSTAL_DOCK_WAYLAND_TRACE set,
+// without a compositor, e.g. for profiling event storms offline:
+//
+//   QT_QPA_PLATFORM=offscreen crystal-dock-trace-replay [--kde|--wlr] [--real-time] <trace>
+
+#include <chrono>
+#include <iostream>
+
+#include <QGuiApplication>
+#include <QStringList>
+
+#include <display/kde_window_manager.h>
+#include <display/wayland_event_trace.h>
+#include <display/window_system.h>
+#include <display/wlr_window_manager.h>
+
+int main(int argc, char** argv) {
+  QGuiApplication app(argc, argv);
+
+  QStringList args = app.arguments();
+  args.removeFirst();
+  const bool realTime = args.removeAll("--real-time") > 0;
+  const bool wlr = args.removeAll("--wlr") > 0;
+  args.removeAll("--kde");
+  if (args.size() != 1) {
+    std::cerr << "Usage: crystal-dock-trace-replay [--kde|--wlr] [--real-time] <trace>"
+              << std::endl;
+    return -1;
+  }
+
+  if (wlr) {
+    crystaldock::WlrWindowManager::connectSignals();
+    crystaldock::WindowSystem::initWithoutCompositor(
+        crystaldock::WlrWindowManager::bindWindowManagerFunctions);
+  } else {
+    crystaldock::KdeWindowManager::connectSignals();
+    crystaldock::WindowSystem::initWithoutCompositor(
+        crystaldock::KdeWindowManager::bindWindowManagerFunctions);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto count = crystaldock::WaylandEventTrace::replay(args[0].toStdString(), realTime);
+  if (count < 0) {
+    return -1;
+  }
+  const auto elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Replayed " << count << " events in " << elapsed * 1000 << " ms ("
+            << (elapsed > 0 ? count / elapsed : 0) << " events/s), "
+            << crystaldock::WindowSystem::windows().size() << " windows remaining." << std::endl;
+  return 0;
+}